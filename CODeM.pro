@@ -11,10 +11,21 @@ SOURCES += \
     main.cpp \
     core/RandomDistributions.cpp \
     core/CODeMDistribution.cpp \
+    core/DistributionCache.cpp \
+    core/DistributionEngine.cpp \
+    core/DistributionTable.cpp \
+    core/EmpiricalDistribution.cpp \
+    core/PeakQuantileSurface.cpp \
     core/CODeMOperators.cpp \
     core/UncertaintyKernel.cpp \
+    core/utils/AliasTable.cpp \
+    core/utils/FFT.cpp \
+    core/utils/GuideTable.cpp \
     core/utils/LinearInterpolator.cpp \
+    core/utils/PrefixScan.cpp \
+    core/utils/RandomStream.cpp \
     core/utils/ScalingUtils.cpp \
+    core/utils/SpecialFunctions.cpp \
     libs/DTLZ/DTLZProblems.cpp \
     libs/WFG/ExampleProblems.cpp \
     libs/WFG/ExampleShapes.cpp \
@@ -29,10 +40,23 @@ SOURCES += \
 HEADERS += \
     core/RandomDistributions.h \
     core/CODeMDistribution.h \
+    core/DistributionCache.h \
+    core/DistributionEngine.h \
+    core/DistributionPool.h \
+    core/DistributionTable.h \
+    core/EmpiricalDistribution.h \
+    core/PeakQuantileSurface.h \
     core/CODeMOperators.h \
     core/UncertaintyKernel.h \
+    core/utils/AliasTable.h \
+    core/utils/ArrayView.h \
+    core/utils/FFT.h \
+    core/utils/GuideTable.h \
     core/utils/LinearInterpolator.h \
+    core/utils/PrefixScan.h \
+    core/utils/RandomStream.h \
     core/utils/ScalingUtils.h \
+    core/utils/SpecialFunctions.h \
     libs/DTLZ/DTLZProblems.h \
     libs/WFG/ExampleProblems.h \
     libs/WFG/ExampleShapes.h \
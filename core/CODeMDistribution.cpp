@@ -33,6 +33,29 @@ using std::vector;
 
 namespace CODeM {
 
+// The substream reserved for the scalar factors of all samples
+const uint32_t FactorSubstream(0xFFFFFFFFu);
+
+CODeMDistribution::CODeMDistribution(const DistributionEngine& d,
+                                     const vector<double>&     oVec,
+                                     double                    lowerBound,
+                                     double                    upperBound,
+                                     const vector<double>&     ideal,
+                                     const vector<double>&     antiIdeal,
+                                     double                    dirPertRad,
+                                     double                    dirPertNorm)
+    : m_engine(d),
+      m_distribution(0),
+      m_directionPertRadius(dirPertRad >= 0.0 ? dirPertRad : 0.0),
+      m_ideal(ideal),
+      m_antiIdeal(antiIdeal),
+      m_lb(lowerBound),
+      m_ub(upperBound),
+      m_pNorm(dirPertNorm > 0.0 ? dirPertNorm : 1.0)
+{
+    defineDirection(oVec);
+}
+
 CODeMDistribution::CODeMDistribution(IDistribution*        d,
                                      const vector<double>& oVec,
                                      double                lowerBound,
@@ -41,7 +64,8 @@ CODeMDistribution::CODeMDistribution(IDistribution*        d,
                                      const vector<double>& antiIdeal,
                                      double                dirPertRad,
                                      double                dirPertNorm)
-    : m_distribution(d),
+    : m_engine(DistributionEngine::external(d)),
+      m_distribution(d),
       m_directionPertRadius(dirPertRad >= 0.0 ? dirPertRad : 0.0),
       m_ideal(ideal),
       m_antiIdeal(antiIdeal),
@@ -59,30 +83,99 @@ CODeMDistribution::~CODeMDistribution()
 
 vector<double> CODeMDistribution::sampleDistribution()
 {
-    if(m_distribution == 0) {
-        return vector<double>(0);
+    RandomStream& rs = globalRandomStream();
+    return drawSample(rs, rs);
+}
+
+vector<double> CODeMDistribution::sampleDistribution(int sampleIdx,
+                                                     const RandomStream& rs)
+{
+    RandomStream factorStream = rs.substream(FactorSubstream);
+    factorStream.seek(sampleIdx);
+    RandomStream perturbationStream = rs.substream(sampleIdx);
+    return drawSample(factorStream, perturbationStream);
+}
+
+vector<vector<double> > CODeMDistribution::sampleDistribution(int firstSample,
+                                                              int nSamp,
+                                                              const RandomStream& rs)
+{
+    int nObj = sampleSize();
+    vector<double> block((size_t)nSamp * nObj);
+    sampleDistribution(firstSample, nSamp, rs, block.data());
+
+    vector<vector<double> > samples(nSamp);
+    for(int i=0; i<nSamp; i++) {
+        samples[i].assign(block.begin() + (size_t)i * nObj,
+                          block.begin() + (size_t)(i + 1) * nObj);
     }
-    double sFactor = m_distribution->sample();
+    return samples;
+}
 
-    // scale to the interval [lb ub]
-    sFactor = m_lb + sFactor*(m_ub-m_lb);
+void CODeMDistribution::sampleDistribution(int firstSample, int nSamp,
+                                           const RandomStream& rs, double* out)
+{
+    int nObj = sampleSize();
+    if((nObj == 0) || (nSamp <= 0)) {
+        return;
+    }
 
-    // scale the 2-norm direction vector
-    vector<double> samp = m_direction;
-    scale(samp, sFactor);
+    // The scalar factors are drawn in one batch into the start of the
+    // buffer. Filling the rows from the last one up reads every factor
+    // before its position is overwritten: row i starts at i*nObj >= i.
+    RandomStream factorStream = rs.substream(FactorSubstream);
+    factorStream.seek(firstSample);
+    m_engine.sample(nSamp, out, factorStream);
 
-    samp = directionPerturbation(samp, m_directionPertRadius, m_pNorm);
+    for(int i = nSamp - 1; i >= 0; i--) {
+        double sFactor = out[i];
+        RandomStream perturbationStream = rs.substream(firstSample + i);
+        factorToSample(sFactor, perturbationStream, out + (size_t)i * nObj);
+    }
+}
 
-    scaleBackFromUnitBox(samp, m_ideal, m_antiIdeal);
+int CODeMDistribution::sampleSize() const
+{
+    if(m_engine.type() == DistributionEngine::EmptyEngine) {
+        return 0;
+    }
+    return (int)m_direction.size();
+}
 
+vector<double> CODeMDistribution::drawSample(RandomStream& factorStream,
+                                             RandomStream& perturbationStream)
+{
+    vector<double> samp(sampleSize());
+    if(samp.empty()) {
+        return samp;
+    }
+    double sFactor = m_engine.sample(factorStream);
+    factorToSample(sFactor, perturbationStream, samp.data());
     return samp;
 }
 
+void CODeMDistribution::factorToSample(double sFactor,
+                                       RandomStream& perturbationStream,
+                                       double* sample)
+{
+    int nObj = (int)m_direction.size();
+
+    // scale to the interval [lb ub]
+    sFactor = m_lb + sFactor*(m_ub-m_lb);
+
+    // scale the 2-norm direction vector, perturb it and scale it back from
+    // the unit box
+    perturbedSample(m_direction.data(), nObj, sFactor, m_directionPertRadius,
+                    m_pNorm, perturbationStream, m_work.data(),
+                    m_ideal.data(), m_antiIdeal.data(), sample);
+}
+
 void CODeMDistribution::defineDirection(const vector<double> &oVec)
 {
     m_direction = oVec;
     normaliseToUnitBox(m_direction, m_ideal, m_antiIdeal);
     toUnitVec(m_direction);
+    m_work.resize(m_direction.size());
 }
 
 } // namespace CODeM
@@ -27,6 +27,7 @@
 #define CODEMDISTRIBUTION_H
 
 #include <core/CODeMGlobal.h>
+#include <core/DistributionEngine.h>
 #include <vector>
 
 
@@ -39,6 +40,16 @@ class IDistribution;
 class CODeMDistribution
 {
 public:
+    // The distribution is stored by value
+    CODeMDistribution(const DistributionEngine&  d,
+                      const std::vector<double>& oVec,
+                      double                     lowerBound,
+                      double                     upperBound,
+                      const std::vector<double>& ideal,
+                      const std::vector<double>& antiIdeal,
+                      double                     dirPertRad,
+                      double                     dirPertNorm);
+    // Takes ownership of d
     CODeMDistribution(IDistribution*             d,
                       const std::vector<double>& oVec,
                       double                     lowerBound,
@@ -50,12 +61,35 @@ public:
     ~CODeMDistribution();
 
     std::vector<double> sampleDistribution();
+    // The sample is a function of the solution stream and the sample index
+    // only: the scalar factor is the sampleIdx-th value of the factor
+    // substream, and the direction perturbation uses substream sampleIdx.
+    std::vector<double> sampleDistribution(int sampleIdx,
+                                           const Utils::RandomStream& rs);
+    // Samples firstSample,...,firstSample+nSamp-1, identical to drawing them
+    // one by one. The scalar factors are drawn in a single batch.
+    std::vector<std::vector<double> > sampleDistribution(int firstSample, int nSamp,
+                                                         const Utils::RandomStream& rs);
+    // The same samples, written row by row into out, which holds
+    // nSamp * sampleSize() values. Nothing is allocated.
+    void sampleDistribution(int firstSample, int nSamp,
+                            const Utils::RandomStream& rs, double* out);
+    // The number of values in a sample: the number of objectives, or 0
+    // without a distribution
+    int  sampleSize() const;
 
 private:
+    std::vector<double> drawSample(Utils::RandomStream& factorStream,
+                                   Utils::RandomStream& perturbationStream);
+    // The sample for the scalar factor sFactor, into sample
+    void factorToSample(double sFactor, Utils::RandomStream& perturbationStream,
+                        double* sample);
+
     // 2-norm direction
     void defineDirection(const std::vector<double> &oVec);
 
-    IDistribution*       m_distribution;
+    DistributionEngine   m_engine;
+    IDistribution*       m_distribution; // owned, when there is one
     double               m_directionPertRadius;
     std::vector<double>  m_direction;
     std::vector<double>  m_ideal;
@@ -63,6 +97,8 @@ private:
     double               m_lb;
     double               m_ub;
     double               m_pNorm;
+    // the perturbation's uniform values, one per objective
+    std::vector<double>  m_work;
 };
 
 } //namespace CODeM
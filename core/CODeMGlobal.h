@@ -26,12 +26,15 @@
 #ifndef CODEMGLOBAL_H
 #define CODEMGLOBAL_H
 
-#include <random>
-#include <ctime>
+#include <core/utils/RandomStream.h>
+#include <cmath>
+#include <cstddef>
 
 namespace CODeM {
 
-inline double randUni() { return (double)(std::rand()) / RAND_MAX; }
+// Draws from the process-wide stream. Use a Utils::RandomStream per solution
+// for reproducible results that do not depend on the evaluation order.
+inline double randUni() { return Utils::globalRandomStream().uniform(); }
 
 inline double factorial(double n) {return tgamma(n + 1.0);}
 
@@ -44,6 +47,21 @@ const double DistPeakMinN(1.0);
 const double DistPeakMaxN(50.0);
 const double DistPeakMinNBasisFunc(30.0);
 const double DistPeakMaxNBasisFunc(150.0);
+// Bound on the Poisson weight mass of the dropped basis functions, which
+// bounds the 2-norm error of the peak wavefunction by its square root
+const double DistPeakTruncationTol(1e-16);
+// How many times finer than the resolution an adaptive grid starts
+const int    DistAdaptiveRefinement(2);
+// Grids from this size on integrate their cdf with the blocked scan
+const int    DistBlockedScanMinSamples(4096);
+// Bound on the number of bins chosen for a histogram of raw samples
+const int    DistEmpiricalMaxBins(1000);
+// Default memory bound of the distribution cache, in bytes
+const std::size_t DistCacheCapacity(64 * 1024 * 1024);
+// Default grid of the peak quantile surface
+const int    PeakSurfaceNTendency(65);
+const int    PeakSurfaceNLocality(65);
+const int    PeakSurfaceNQuantiles(513);
 
 } // namespace CODeM
 
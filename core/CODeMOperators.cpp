@@ -25,13 +25,97 @@
 ****************************************************************************/
 #include <core/CODeMOperators.h>
 #include <core/utils/ScalingUtils.h>
-#include <random>
 #include <math.h>
+#include <algorithm>
 
 using namespace CODeM::Utils;
 
 namespace CODeM {
 
+namespace {
+
+// The steps of directionPerturbation(), with the scaling by factor before
+// and the optional scale back after them fused into the passes
+template <NormType N>
+void perturbationKernel(const double* dir, int n, double factor,
+                        double maxRadius, double pNorm, RandomStream& rs,
+                        double* u, const double* lBounds,
+                        const double* uBounds, double* out)
+{
+    // the scaled vector, with its p-norm and its sum for the projection
+    // on the k-1 simplex
+    double sumP = 0.0;
+    double sum1 = 0.0;
+    for(int i=0; i<n; i++) {
+        double x = dir[i] * factor;
+        out[i] = x;
+        sumP = NormKernel<N>::accumulate(sumP, x, pNorm);
+        sum1 = NormKernel<OneNorm>::accumulate(sum1, x, 1.0);
+    }
+    double dist = NormKernel<N>::finish(sumP, pNorm);
+    double inv1 = 1.0 / sum1;
+
+    // perturb within a sphere with r=maxRadius
+    rs.fill(u, n);
+    double r2    = maxRadius * maxRadius;
+    double s     = 0.0;
+    double normP = 0.0;
+    for(int i=0; i<n; i++) {
+        double rd = (u[i] * 2.0 - 1.0) * sqrt(r2 - s);
+        s += rd * rd;
+        double x = out[i] * inv1 + rd;
+        out[i] = x;
+        normP = NormKernel<N>::accumulate(normP, x, pNorm);
+    }
+
+    // project on the p-norm unit sphere, scale back to the distance and,
+    // if bounds are given, out of the unit box
+    double invP = 1.0 / NormKernel<N>::finish(normP, pNorm);
+    if(lBounds == 0) {
+        for(int i=0; i<n; i++) {
+            out[i] = out[i] * invP * dist;
+        }
+        return;
+    }
+    for(int i=0; i<n; i++) {
+        double x     = out[i] * invP * dist;
+        double range = uBounds[i] - lBounds[i];
+        if(x > 1.0) {
+            out[i] = uBounds[i] - (1.0 - x) * range;
+        } else if(x < 0.0) {
+            out[i] = lBounds[i] - x * range;
+        } else {
+            out[i] = lBounds[i] + x * range;
+        }
+    }
+}
+
+void perturbation(const double* dir, int n, double factor, double maxRadius,
+                  double pNorm, RandomStream& rs, double* u,
+                  const double* lBounds, const double* uBounds, double* out)
+{
+    switch(normType(pNorm)) {
+    case OneNorm:
+        perturbationKernel<OneNorm>(dir, n, factor, maxRadius, pNorm, rs, u,
+                                    lBounds, uBounds, out);
+        break;
+    case TwoNorm:
+        perturbationKernel<TwoNorm>(dir, n, factor, maxRadius, pNorm, rs, u,
+                                    lBounds, uBounds, out);
+        break;
+    case MaxNorm:
+        perturbationKernel<MaxNorm>(dir, n, factor, maxRadius, pNorm, rs, u,
+                                    lBounds, uBounds, out);
+        break;
+    default:
+        perturbationKernel<GeneralNorm>(dir, n, factor, maxRadius, pNorm, rs,
+                                        u, lBounds, uBounds, out);
+        break;
+    }
+}
+
+} // namespace
+
 double linearDecrease(double val)
 {
     return 1.0 - val;
@@ -59,31 +143,90 @@ double highOnValue(double val, double oneVal, double width)
     return (ret<0.0) ? 0.0 : ret;
 }
 
-std::vector<double> directionPerturbation(const std::vector<double> &oVec,
-                                     double maxRadius, double pNorm)
+void linearDecrease(const double* val, int n, double* out)
 {
-    // project on the k-1 simplex
-    std::vector<double> newObjVec(oVec);
-    toUnitVec(newObjVec, 1.0);
+    for(int i=0; i<n; i++) {
+        out[i] = 1.0 - val[i];
+    }
+}
 
-    // calculate the p-distance
-    double dist = magnitudeP(oVec, pNorm);
+void skewedIncrease(const double* val, int n, double alpha, double* out)
+{
+    if(alpha<0) {
+        std::fill(out, out + n, 1.0);
+        return;
+    }
+    for(int i=0; i<n; i++) {
+        out[i] = pow(val[i], alpha);
+    }
+}
 
-    // perturb within a sphere with r=maxRadius
-    double s = 0.0;
-    for(int i=0; i<newObjVec.size(); i++) {
-        double rd = (randUni() * 2.0 -1.0) * sqrt(maxRadius*maxRadius - s);
-        s += pow(rd, 2.0);
-        newObjVec[i] += rd;
+void skewedDecrease(const double* val, int n, double alpha, double* out)
+{
+    if(alpha<0) {
+        std::fill(out, out + n, 0.0);
+        return;
+    }
+    for(int i=0; i<n; i++) {
+        out[i] = 1.0 - pow(val[i], alpha);
+    }
+}
+
+void lowOnValue(const double* val, int n, double zeroVal, double width,
+                double* out)
+{
+    double c = 4.0 / pow(width, 2.0);
+    for(int i=0; i<n; i++) {
+        double d   = val[i] - zeroVal;
+        double ret = c * (d * d);
+        out[i] = (ret>1.0) ? 1.0 : ret;
     }
+}
 
-    // project on the p-norm unit sphere
-    toUnitVec(newObjVec, pNorm);
+void highOnValue(const double* val, int n, double oneVal, double width,
+                 double* out)
+{
+    double c = 4.0 / pow(width, 2.0);
+    for(int i=0; i<n; i++) {
+        double d   = val[i] - oneVal;
+        double ret = 1.0 - c * (d * d);
+        out[i] = (ret<0.0) ? 0.0 : ret;
+    }
+}
 
-    //scale back
-    scale(newObjVec, dist);
+std::vector<double> directionPerturbation(const std::vector<double> &oVec,
+                                     double maxRadius, double pNorm)
+{
+    return directionPerturbation(oVec, maxRadius, pNorm, globalRandomStream());
+}
 
+std::vector<double> directionPerturbation(const std::vector<double> &oVec,
+                                          double maxRadius, double pNorm,
+                                          RandomStream& rs)
+{
+    std::vector<double> newObjVec(oVec);
+    std::vector<double> u(newObjVec.size());
+    directionPerturbation(newObjVec.data(), (int)newObjVec.size(), maxRadius,
+                          pNorm, rs, u.data());
     return newObjVec;
 }
 
+void directionPerturbation(double* vec, int n, double maxRadius, double pNorm,
+                           RandomStream& rs, double* u)
+{
+    // the project on the k-1 simplex, the perturbation within a sphere with
+    // r=maxRadius and the projection on the p-norm unit sphere, scaled back
+    // to the p-distance of vec
+    perturbation(vec, n, 1.0, maxRadius, pNorm, rs, u, 0, 0, vec);
+}
+
+void perturbedSample(const double* dir, int n, double factor,
+                     double maxRadius, double pNorm, RandomStream& rs,
+                     double* u, const double* lBounds, const double* uBounds,
+                     double* out)
+{
+    perturbation(dir, n, factor, maxRadius, pNorm, rs, u, lBounds, uBounds,
+                 out);
+}
+
 } // namespace CODeM
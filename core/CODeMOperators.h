@@ -37,9 +37,30 @@ double skewedIncrease(double val, double alpha);
 double skewedDecrease(double val, double alpha);
 double lowOnValue(double val, double zeroVal, double width);
 double highOnValue(double val, double oneVal, double width);
+// The same relations for a column of n values, into out (which may be val)
+void linearDecrease(const double* val, int n, double* out);
+void skewedIncrease(const double* val, int n, double alpha, double* out);
+void skewedDecrease(const double* val, int n, double alpha, double* out);
+void lowOnValue(const double* val, int n, double zeroVal, double width,
+                double* out);
+void highOnValue(const double* val, int n, double oneVal, double width,
+                 double* out);
 
 std::vector<double> directionPerturbation(const std::vector<double> &oVec,
                                           double maxRadius, double pNorm=2);
+std::vector<double> directionPerturbation(const std::vector<double> &oVec,
+                                          double maxRadius, double pNorm,
+                                          Utils::RandomStream& rs);
+// The same, in place for the n values at vec. u is a buffer for n values.
+void directionPerturbation(double* vec, int n, double maxRadius, double pNorm,
+                           Utils::RandomStream& rs, double* u);
+// directionPerturbation() of factor * dir followed by scaleBackFromUnitBox(),
+// into out, in three passes over the n values. The 1-, 2- and maximum norms
+// need no pow() calls.
+void perturbedSample(const double* dir, int n, double factor,
+                     double maxRadius, double pNorm, Utils::RandomStream& rs,
+                     double* u, const double* lBounds, const double* uBounds,
+                     double* out);
 
 } // namespace CODeM
 
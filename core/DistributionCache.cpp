@@ -0,0 +1,195 @@
+/****************************************************************************
+**
+** The MIT License (MIT)
+**
+** Copyright (c) 2016 The University of Sheffield (www.sheffield.ac.uk)
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in all
+** copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE
+**
+****************************************************************************/
+#include <core/DistributionCache.h>
+
+#include <math.h>
+
+using std::shared_ptr;
+using std::size_t;
+
+namespace CODeM {
+
+/// DISTRIBUTION KEY
+DistributionKey::DistributionKey()
+    : type(0)
+{
+    for(int i = 0; i < NParams; i++) {
+        params[i] = 0.0;
+    }
+}
+
+bool DistributionKey::operator<(const DistributionKey& other) const
+{
+    if(type != other.type) {
+        return type < other.type;
+    }
+    for(int i = 0; i < NParams; i++) {
+        if(params[i] != other.params[i]) {
+            return params[i] < other.params[i];
+        }
+    }
+    return false;
+}
+
+/// DISTRIBUTION CACHE
+DistributionCache& DistributionCache::instance()
+{
+    static DistributionCache cache;
+    return cache;
+}
+
+DistributionCache::DistributionCache()
+    : m_tolerance(0.0),
+      m_capacity(DistCacheCapacity),
+      m_memoryUsage(0),
+      m_hits(0),
+      m_misses(0)
+{
+
+}
+
+void DistributionCache::defineTolerance(double tol)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(tol != m_tolerance) {
+        // tables computed on another grid must not be reused
+        m_entries.clear();
+        m_index.clear();
+        m_memoryUsage = 0;
+    }
+    m_tolerance = (tol > 0.0) ? tol : 0.0;
+}
+
+double DistributionCache::tolerance() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_tolerance;
+}
+
+bool DistributionCache::isEnabled() const
+{
+    return tolerance() > 0.0;
+}
+
+double DistributionCache::quantise(double val) const
+{
+    double tol = tolerance();
+    if(tol <= 0.0) {
+        return val;
+    }
+    return floor(val / tol + 0.5) * tol;
+}
+
+void DistributionCache::defineCapacity(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_capacity = bytes;
+    evict();
+}
+
+size_t DistributionCache::capacity() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_capacity;
+}
+
+size_t DistributionCache::memoryUsage() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_memoryUsage;
+}
+
+size_t DistributionCache::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+shared_ptr<const DistributionTable> DistributionCache::find(const DistributionKey& key)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::map<DistributionKey, std::list<Entry>::iterator>::iterator it
+            = m_index.find(key);
+    if(it == m_index.end()) {
+        ++m_misses;
+        return shared_ptr<const DistributionTable>();
+    }
+    ++m_hits;
+    // move to the front of the recently used list
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return it->second->second;
+}
+
+void DistributionCache::insert(const DistributionKey& key,
+                               shared_ptr<const DistributionTable> table)
+{
+    if(!table) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_index.count(key) > 0) {
+        // another thread computed the same table meanwhile
+        return;
+    }
+    m_entries.push_front(Entry(key, table));
+    m_index[key] = m_entries.begin();
+    m_memoryUsage += table->memorySize();
+    evict();
+}
+
+void DistributionCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_index.clear();
+    m_memoryUsage = 0;
+    m_hits   = 0;
+    m_misses = 0;
+}
+
+unsigned long long DistributionCache::hits() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hits;
+}
+
+unsigned long long DistributionCache::misses() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_misses;
+}
+
+void DistributionCache::evict()
+{
+    // call with the mutex locked
+    while((m_memoryUsage > m_capacity) && !m_entries.empty()) {
+        m_memoryUsage -= m_entries.back().second->memorySize();
+        m_index.erase(m_entries.back().first);
+        m_entries.pop_back();
+    }
+}
+
+} // namespace CODeM
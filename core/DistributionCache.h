@@ -0,0 +1,107 @@
+/****************************************************************************
+**
+** The MIT License (MIT)
+**
+** Copyright (c) 2016 The University of Sheffield (www.sheffield.ac.uk)
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in all
+** copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE
+**
+****************************************************************************/
+#ifndef DISTRIBUTIONCACHE_H
+#define DISTRIBUTIONCACHE_H
+
+#include <core/CODeMGlobal.h>
+#include <core/DistributionTable.h>
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <cstddef>
+
+namespace CODeM {
+
+// Identifies a computed distribution: its type and its parameters, already
+// quantised to the cache tolerance
+struct DistributionKey
+{
+    enum { NParams = 6 };
+
+    DistributionKey();
+
+    int    type;
+    double params[NParams];
+
+    bool operator<(const DistributionKey& other) const;
+};
+
+/*  A process-wide, thread-safe cache of distribution tables with a least
+ *  recently used eviction policy and a bound on the memory it holds.
+ *  Distributions whose parameters are within the tolerance of each other
+ *  share one table: the parameters are snapped to a grid with the tolerance
+ *  as its step before the table is computed, so the results do not depend on
+ *  the order of the evaluations. The cache is disabled while the tolerance is
+ *  not positive. */
+class DistributionCache
+{
+public:
+    static DistributionCache& instance();
+
+    void        defineTolerance(double tol);
+    double      tolerance()   const;
+    bool        isEnabled()   const;
+    // Snap a parameter to the cache grid
+    double      quantise(double val) const;
+
+    void        defineCapacity(std::size_t bytes);
+    std::size_t capacity()    const;
+    std::size_t memoryUsage() const;
+    std::size_t size()        const;
+
+    std::shared_ptr<const DistributionTable> find(const DistributionKey& key);
+    void insert(const DistributionKey& key,
+                std::shared_ptr<const DistributionTable> table);
+    void clear();
+
+    unsigned long long hits()   const;
+    unsigned long long misses() const;
+
+private:
+    DistributionCache();
+    DistributionCache(const DistributionCache&);
+    DistributionCache& operator=(const DistributionCache&);
+
+    void evict();
+
+    typedef std::pair<DistributionKey,
+                      std::shared_ptr<const DistributionTable> > Entry;
+
+    mutable std::mutex  m_mutex;
+    std::list<Entry>    m_entries; // most recently used first
+    std::map<DistributionKey, std::list<Entry>::iterator> m_index;
+    double              m_tolerance;
+    std::size_t         m_capacity;
+    std::size_t         m_memoryUsage;
+    unsigned long long  m_hits;
+    unsigned long long  m_misses;
+};
+
+} // namespace CODeM
+
+#endif // DISTRIBUTIONCACHE_H
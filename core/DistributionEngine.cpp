@@ -0,0 +1,305 @@
+/****************************************************************************
+**
+** The MIT License (MIT)
+**
+** Copyright (c) 2016 The University of Sheffield (www.sheffield.ac.uk)
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in all
+** copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE
+**
+****************************************************************************/
+#include <core/DistributionEngine.h>
+#include <core/DistributionPool.h>
+#include <core/RandomDistributions.h>
+#include <core/PeakQuantileSurface.h>
+
+#include <math.h>
+#include <algorithm>
+
+using CODeM::Utils::RandomStream;
+using std::size_t;
+
+namespace CODeM {
+
+namespace {
+
+// The distributions that build the peak tables
+DistributionPool<PeakDistribution>& peakPool()
+{
+    static DistributionPool<PeakDistribution> pool;
+    return pool;
+}
+
+} // namespace
+
+/// COMPONENT
+DistributionEngine::Component::Component()
+    : type(EmptyEngine),
+      lb(0.0),
+      ub(1.0),
+      tendency(0.5),
+      locality(1.0),
+      ascend(true)
+{
+
+}
+
+void DistributionEngine::Component::prepare()
+{
+    if((type == PeakEngine) && !table
+            && !PeakQuantileSurface::instance().isLoaded()) {
+        DistributionPool<PeakDistribution>::Handle d(peakPool());
+        d->reset(tendency, locality);
+        table = d->table();
+    }
+}
+
+double DistributionEngine::Component::transformUniform(double u) const
+{
+    switch(type) {
+    case UniformEngine:
+        return lb + u * (ub - lb);
+    case LinearEngine:
+        if(ascend) {
+            return lb + sqrt(u) * (ub - lb);
+        } else {
+            return ub - sqrt(1 - u) * (ub - lb);
+        }
+    case PeakEngine:
+    {
+        const PeakQuantileSurface& surface = PeakQuantileSurface::instance();
+        if(surface.isLoaded()) {
+            return lb + surface.quantile(tendency, locality, u) * (ub - lb);
+        }
+        return table->quantile(u);
+    }
+    default:
+        return u;
+    }
+}
+
+void DistributionEngine::Component::transformUniforms(size_t n, double* u) const
+{
+    double range = ub - lb;
+    switch(type) {
+    case UniformEngine:
+        for(size_t i=0; i<n; i++) {
+            u[i] = lb + u[i] * range;
+        }
+        break;
+    case LinearEngine:
+        if(ascend) {
+            for(size_t i=0; i<n; i++) {
+                u[i] = lb + sqrt(u[i]) * range;
+            }
+        } else {
+            for(size_t i=0; i<n; i++) {
+                u[i] = ub - sqrt(1 - u[i]) * range;
+            }
+        }
+        break;
+    case PeakEngine:
+        if(PeakQuantileSurface::instance().isLoaded()) {
+            const PeakQuantileSurface& surface = PeakQuantileSurface::instance();
+            for(size_t i=0; i<n; i++) {
+                u[i] = lb + range * surface.quantile(tendency, locality, u[i]);
+            }
+        } else {
+            table->quantiles(n, u);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/// DISTRIBUTION ENGINE
+DistributionEngine::DistributionEngine()
+    : m_type(EmptyEngine),
+      m_nComponents(0),
+      m_external(0)
+{
+    for(int i = 0; i < MaxComponents; i++) {
+        m_ratios[i]           = 0.0;
+        m_cumulativeRatios[i] = 0.0;
+    }
+}
+
+DistributionEngine DistributionEngine::uniform(double lb, double ub)
+{
+    IDistribution::correctBoundaries(lb, ub);
+    DistributionEngine engine;
+    engine.m_type        = UniformEngine;
+    engine.m_nComponents = 1;
+    engine.m_components[0].type = UniformEngine;
+    engine.m_components[0].lb   = lb;
+    engine.m_components[0].ub   = ub;
+    return engine;
+}
+
+DistributionEngine DistributionEngine::linear(double lb, double ub, bool ascend)
+{
+    IDistribution::correctBoundaries(lb, ub);
+    DistributionEngine engine;
+    engine.m_type        = LinearEngine;
+    engine.m_nComponents = 1;
+    engine.m_components[0].type   = LinearEngine;
+    engine.m_components[0].lb     = lb;
+    engine.m_components[0].ub     = ub;
+    engine.m_components[0].ascend = ascend;
+    return engine;
+}
+
+DistributionEngine DistributionEngine::peak(double tendency, double locality)
+{
+    DistributionEngine engine;
+    engine.m_type        = PeakEngine;
+    engine.m_nComponents = 1;
+    engine.m_components[0].type     = PeakEngine;
+    engine.m_components[0].tendency = std::min(std::max(tendency, 0.0), 1.0);
+    engine.m_components[0].locality = std::min(std::max(locality, 0.0), 1.0);
+    return engine;
+}
+
+DistributionEngine DistributionEngine::external(IDistribution* d)
+{
+    DistributionEngine engine;
+    if(d != 0) {
+        engine.m_type     = ExternalEngine;
+        engine.m_external = d;
+    }
+    return engine;
+}
+
+bool DistributionEngine::appendComponent(const DistributionEngine& d,
+                                         double ratio)
+{
+    if(((m_type != EmptyEngine) && (m_type != MixtureEngine))
+            || (m_nComponents == MaxComponents)) {
+        return false;
+    }
+    if((d.m_type != UniformEngine) && (d.m_type != LinearEngine)
+            && (d.m_type != PeakEngine)) {
+        return false;
+    }
+
+    m_type = MixtureEngine;
+    m_components[m_nComponents] = d.m_components[0];
+    m_ratios[m_nComponents]     = std::max(ratio, 0.0);
+    m_nComponents++;
+
+    double total = 0.0;
+    for(int i = 0; i < m_nComponents; i++) {
+        total += m_ratios[i];
+    }
+    double cumulative = 0.0;
+    for(int i = 0; i < m_nComponents; i++) {
+        cumulative += m_ratios[i];
+        m_cumulativeRatios[i] = (total > 0.0) ? cumulative / total
+                                              : (i + 1.0) / m_nComponents;
+    }
+    return true;
+}
+
+DistributionEngine::Type DistributionEngine::type() const
+{
+    return m_type;
+}
+
+int DistributionEngine::nComponents() const
+{
+    return m_nComponents;
+}
+
+void DistributionEngine::prepare()
+{
+    for(int i = 0; i < m_nComponents; i++) {
+        m_components[i].prepare();
+    }
+}
+
+double DistributionEngine::transformUniform(double u)
+{
+    switch(m_type) {
+    case EmptyEngine:
+        return 0.0;
+    case ExternalEngine:
+        return m_external->transformUniform(u);
+    case MixtureEngine:
+    {
+        prepare();
+        double v;
+        int i = component(u, v);
+        return m_components[i].transformUniform(v);
+    }
+    default:
+        m_components[0].prepare();
+        return m_components[0].transformUniform(u);
+    }
+}
+
+double DistributionEngine::sample(RandomStream& rs)
+{
+    if(m_type == ExternalEngine) {
+        return m_external->sample(rs);
+    }
+    return transformUniform(rs.uniform());
+}
+
+void DistributionEngine::sample(size_t n, double* out, RandomStream& rs)
+{
+    switch(m_type) {
+    case EmptyEngine:
+        std::fill(out, out + n, 0.0);
+        break;
+    case ExternalEngine:
+        m_external->sample(n, out, rs);
+        break;
+    case MixtureEngine:
+        prepare();
+        rs.fill(out, n);
+        for(size_t i=0; i<n; i++) {
+            double v;
+            int c = component(out[i], v);
+            out[i] = m_components[c].transformUniform(v);
+        }
+        break;
+    default:
+        m_components[0].prepare();
+        rs.fill(out, n);
+        m_components[0].transformUniforms(n, out);
+        break;
+    }
+}
+
+int DistributionEngine::component(double u, double& v) const
+{
+    // The same uniform value picks the component and, rescaled to the
+    // component's share of [0,1], samples it
+    int last = m_nComponents - 1;
+    int i = (int)(std::upper_bound(m_cumulativeRatios,
+                                   m_cumulativeRatios + last, u)
+                  - m_cumulativeRatios);
+    double lower = (i == 0) ? 0.0 : m_cumulativeRatios[i-1];
+    double share = m_cumulativeRatios[i] - lower;
+    v = (share > 0.0) ? (u - lower) / share : 0.0;
+    v = std::min(std::max(v, 0.0), 1.0);
+    return i;
+}
+
+} // namespace CODeM
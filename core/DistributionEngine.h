@@ -0,0 +1,118 @@
+/****************************************************************************
+**
+** The MIT License (MIT)
+**
+** Copyright (c) 2016 The University of Sheffield (www.sheffield.ac.uk)
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in all
+** copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE
+**
+****************************************************************************/
+#ifndef DISTRIBUTIONENGINE_H
+#define DISTRIBUTIONENGINE_H
+
+#include <core/CODeMGlobal.h>
+#include <core/DistributionTable.h>
+
+#include <memory>
+#include <cstddef>
+
+namespace CODeM {
+
+class IDistribution;
+
+/*  A value type for the common distributions: uniform, linear, peak, and
+ *  mixtures of up to MaxComponents of these. Everything is stored inline, so
+ *  an engine is created and copied without allocating, apart from the
+ *  shared table of a peak. Batches are dispatched on the type once, not per
+ *  sample. Other distributions are reached through the IDistribution
+ *  hierarchy, as external engines.
+ *
+ *  An engine gives exactly the samples of the equivalent IDistribution for
+ *  the same stream. */
+class DistributionEngine
+{
+public:
+    enum Type {
+        EmptyEngine,
+        UniformEngine,
+        LinearEngine,
+        PeakEngine,
+        MixtureEngine,
+        ExternalEngine   // an IDistribution, not owned
+    };
+
+    enum { MaxComponents = 4 };
+
+    DistributionEngine();
+
+    static DistributionEngine uniform(double lb, double ub);
+    static DistributionEngine linear(double lb, double ub, bool ascend = true);
+    static DistributionEngine peak(double tendency, double locality);
+    static DistributionEngine external(IDistribution* d);
+
+    // Adds a uniform, linear or peak component to a mixture, as
+    // MergedDistribution::appendDistribution() in mixture sampling. An empty
+    // engine becomes a mixture. Returns false for other engines, or when
+    // the mixture is full.
+    bool   appendComponent(const DistributionEngine& d, double ratio);
+
+    Type   type()           const;
+    int    nComponents()    const;
+
+    // Builds the tables of the peak components, if they need any. Sampling
+    // does this when needed.
+    void   prepare();
+
+    double transformUniform(double u);
+    double sample(Utils::RandomStream& rs);
+    void   sample(std::size_t n, double* out, Utils::RandomStream& rs);
+
+private:
+    // One uniform, linear or peak distribution
+    struct Component
+    {
+        Component();
+
+        void   prepare();
+        double transformUniform(double u) const;
+        void   transformUniforms(std::size_t n, double* u) const;
+
+        Type   type;
+        double lb;
+        double ub;
+        double tendency;
+        double locality;
+        bool   ascend;
+        std::shared_ptr<const DistributionTable> table;
+    };
+
+    int    component(double u, double& v) const;
+
+    Type           m_type;
+    int            m_nComponents;
+    Component      m_components[MaxComponents];
+    double         m_ratios[MaxComponents];
+    // the normalised ratios, accumulated
+    double         m_cumulativeRatios[MaxComponents];
+    IDistribution* m_external;
+};
+
+} // namespace CODeM
+
+#endif // DISTRIBUTIONENGINE_H
@@ -0,0 +1,116 @@
+/****************************************************************************
+**
+** The MIT License (MIT)
+**
+** Copyright (c) 2016 The University of Sheffield (www.sheffield.ac.uk)
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in all
+** copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE
+**
+****************************************************************************/
+#ifndef DISTRIBUTIONPOOL_H
+#define DISTRIBUTIONPOOL_H
+
+#include <core/CODeMGlobal.h>
+
+#include <vector>
+#include <mutex>
+#include <cstddef>
+
+namespace CODeM {
+
+/*  A thread-safe pool of distributions that are reparameterised in place
+ *  with their reset() functions instead of being allocated for every use.
+ *  Released distributions keep their tables and work buffers, so rebuilding
+ *  one of a similar size reuses the memory of its previous build.
+ *
+ *      DistributionPool<PeakDistribution>::Handle d(pool);
+ *      d->reset(tendency, locality);
+ *
+ *  Every acquired distribution must be released before the pool is
+ *  destroyed. */
+template <typename T>
+class DistributionPool
+{
+public:
+    // Acquires a distribution for its lifetime
+    class Handle
+    {
+    public:
+        explicit Handle(DistributionPool& pool)
+            : m_pool(pool), m_d(pool.acquire()) {}
+        ~Handle() {m_pool.release(m_d);}
+
+        T* operator->() const {return m_d;}
+        T& operator*()  const {return *m_d;}
+
+    private:
+        Handle(const Handle&);
+        Handle& operator=(const Handle&);
+
+        DistributionPool& m_pool;
+        T*                m_d;
+    };
+
+    DistributionPool() : m_nCreated(0) {}
+    ~DistributionPool()
+    {
+        for(std::size_t i = 0; i < m_free.size(); i++) {
+            delete m_free[i];
+        }
+    }
+
+    // A released distribution, or a new one if there is none. Its
+    // parameters are those of its last use until it is reset.
+    T* acquire()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(m_free.empty()) {
+            ++m_nCreated;
+            return new T;
+        }
+        T* d = m_free.back();
+        m_free.pop_back();
+        return d;
+    }
+
+    void release(T* d)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_free.push_back(d);
+    }
+
+    // The distributions created by the pool so far
+    std::size_t nCreated() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_nCreated;
+    }
+
+private:
+    DistributionPool(const DistributionPool&);
+    DistributionPool& operator=(const DistributionPool&);
+
+    mutable std::mutex m_mutex;
+    std::vector<T*>    m_free;
+    std::size_t        m_nCreated;
+};
+
+} // namespace CODeM
+
+#endif // DISTRIBUTIONPOOL_H
@@ -0,0 +1,72 @@
+/****************************************************************************
+**
+** The MIT License (MIT)
+**
+** Copyright (c) 2016 The University of Sheffield (www.sheffield.ac.uk)
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in all
+** copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE
+**
+****************************************************************************/
+#include <core/DistributionTable.h>
+
+using std::size_t;
+
+namespace CODeM {
+
+double DistributionTable::quantile(double u) const
+{
+    if(guide.isEmpty()) {
+        // a single point, or no table at all
+        return z.empty() ? 0.0 : z[0];
+    }
+    int j = guide.bracket(u, cdf.data());
+    double dc = cdf[j+1] - cdf[j];
+    if(dc <= 0.0) {
+        return z[j];
+    }
+    return z[j] + (u - cdf[j]) / dc * (z[j+1] - z[j]);
+}
+
+void DistributionTable::quantiles(size_t n, double* u) const
+{
+    for(size_t i=0; i<n; i++) {
+        u[i] = quantile(u[i]);
+    }
+}
+
+double DistributionTable::sample(Utils::RandomStream& rs) const
+{
+    return quantile(rs.uniform());
+}
+
+void DistributionTable::sample(size_t n, double* out,
+                               Utils::RandomStream& rs) const
+{
+    rs.fill(out, n);
+    quantiles(n, out);
+}
+
+size_t DistributionTable::memorySize() const
+{
+    return sizeof(DistributionTable)
+            + sizeof(double) * (z.size() + pdf.size() + cdf.size())
+            + sizeof(int) * z.size();
+}
+
+} // namespace CODeM
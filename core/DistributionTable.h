@@ -0,0 +1,62 @@
+/****************************************************************************
+**
+** The MIT License (MIT)
+**
+** Copyright (c) 2016 The University of Sheffield (www.sheffield.ac.uk)
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in all
+** copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE
+**
+****************************************************************************/
+#ifndef DISTRIBUTIONTABLE_H
+#define DISTRIBUTIONTABLE_H
+
+#include <core/CODeMGlobal.h>
+#include <core/utils/GuideTable.h>
+
+#include <vector>
+#include <cstddef>
+
+namespace CODeM {
+
+/*  The tables of a computed distribution: its grid, pdf and cdf, and the
+ *  guide table that inverts the cdf. Tables are built once and then shared
+ *  as std::shared_ptr<const DistributionTable>, by distributions, by the
+ *  DistributionCache, and by any number of threads. Sampling a table is
+ *  const and keeps no state, so every thread only needs its own stream. */
+struct DistributionTable
+{
+    std::vector<double> z;
+    std::vector<double> pdf;
+    std::vector<double> cdf;
+    Utils::GuideTable   guide;
+
+    // The inverse of the cdf, for one value or in place for a block
+    double      quantile(double u)                  const;
+    void        quantiles(std::size_t n, double* u) const;
+
+    double      sample(Utils::RandomStream& rs)     const;
+    void        sample(std::size_t n, double* out,
+                       Utils::RandomStream& rs)     const;
+
+    std::size_t memorySize() const;
+};
+
+} // namespace CODeM
+
+#endif // DISTRIBUTIONTABLE_H
@@ -0,0 +1,463 @@
+/****************************************************************************
+**
+** The MIT License (MIT)
+**
+** Copyright (c) 2016 The University of Sheffield (www.sheffield.ac.uk)
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in all
+** copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE
+**
+****************************************************************************/
+#include <core/EmpiricalDistribution.h>
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+using CODeM::Utils::RandomStream;
+using std::string;
+using std::vector;
+using std::size_t;
+
+namespace CODeM {
+
+namespace {
+
+const char     EmpiricalMagic[8] = {'C', 'O', 'D', 'e', 'M', 'E', 'M', 'P'};
+const uint32_t EmpiricalByteOrder(0x01020304u);
+const uint32_t EmpiricalVersion(1);
+
+enum {
+    HistogramFile = 0,
+    SamplesFile   = 1
+};
+
+struct EmpiricalHeader
+{
+    char     magic[8];
+    uint32_t byteOrder;
+    uint32_t version;
+    uint32_t kind;
+    uint32_t n;
+};
+
+// Reads the values of a binary file of the given kind. Returns false if
+// the file is not binary, and sets valid to false if it is but cannot be
+// read.
+bool readBinary(const string& fileName, uint32_t kind, vector<double>& values,
+                uint32_t& n, bool& valid)
+{
+    valid = false;
+    std::ifstream ifs(fileName.c_str(), std::ifstream::in | std::ifstream::binary);
+    EmpiricalHeader header;
+    if(!ifs.read((char*)&header, sizeof(header))
+            || (memcmp(header.magic, EmpiricalMagic, sizeof(header.magic)) != 0)) {
+        return false;
+    }
+    if((header.byteOrder != EmpiricalByteOrder)
+            || (header.version != EmpiricalVersion)
+            || (header.kind != kind) || (header.n == 0)) {
+        return true;
+    }
+    n = header.n;
+    size_t nValues = (kind == HistogramFile) ? 2 * (size_t)n + 1 : (size_t)n;
+    values.resize(nValues);
+    valid = (bool)ifs.read((char*)values.data(), nValues * sizeof(double));
+    return true;
+}
+
+// Splits a text line into numbers separated by commas or white space.
+// Returns false if anything else is found.
+bool parseLine(string line, vector<double>& values)
+{
+    values.clear();
+    std::replace(line.begin(), line.end(), ',', ' ');
+    std::istringstream iss(line);
+    double x;
+    while(iss >> x) {
+        values.push_back(x);
+    }
+    return iss.eof();
+}
+
+// The rows of a text file, without comments and blank lines. A first row
+// that is not numeric is taken as a header and skipped.
+bool readText(const string& fileName, vector<vector<double> >& rows)
+{
+    std::ifstream ifs(fileName.c_str());
+    if(!ifs) {
+        return false;
+    }
+    rows.clear();
+    string line;
+    vector<double> values;
+    bool first = true;
+    while(std::getline(ifs, line)) {
+        size_t start = line.find_first_not_of(" \t\r");
+        if((start == string::npos) || (line[start] == '#')) {
+            continue;
+        }
+        if(!parseLine(line, values)) {
+            if(first) {
+                first = false;
+                continue;
+            }
+            return false;
+        }
+        first = false;
+        if(!values.empty()) {
+            rows.push_back(values);
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+EmpiricalDistribution::EmpiricalDistribution()
+    : m_smoothing(false)
+{
+    defineHistogram(vector<double>{0.0, 1.0}, vector<double>(1, 1.0));
+}
+
+EmpiricalDistribution::EmpiricalDistribution(const vector<double>& edges,
+                                             const vector<double>& weights)
+    : m_smoothing(false)
+{
+    if(!defineHistogram(edges, weights)) {
+        defineHistogram(vector<double>{0.0, 1.0}, vector<double>(1, 1.0));
+    }
+}
+
+EmpiricalDistribution::~EmpiricalDistribution()
+{
+
+}
+
+bool EmpiricalDistribution::defineHistogram(const vector<double>& edges,
+                                            const vector<double>& weights)
+{
+    if(weights.empty() || (edges.size() != weights.size() + 1)) {
+        return false;
+    }
+    for(size_t i = 1; i < edges.size(); i++) {
+        if(!(edges[i] > edges[i-1]) || !isfinite(edges[i])
+                || !isfinite(edges[i-1])) {
+            return false;
+        }
+    }
+    Utils::AliasTable alias;
+    if(!alias.define(weights)) {
+        return false;
+    }
+
+    m_alias = alias;
+    m_edges = edges;
+    double total = 0.0;
+    for(size_t i = 0; i < weights.size(); i++) {
+        total += weights[i];
+    }
+    m_probabilities.resize(weights.size());
+    for(size_t i = 0; i < weights.size(); i++) {
+        m_probabilities[i] = weights[i] / total;
+    }
+    m_lb = m_edges.front();
+    m_ub = m_edges.back();
+    updateBins();
+    return true;
+}
+
+bool EmpiricalDistribution::defineSamples(const vector<double>& samples,
+                                          int nBins)
+{
+    if(samples.empty()) {
+        return false;
+    }
+    double lb = samples[0];
+    double ub = samples[0];
+    for(size_t i = 0; i < samples.size(); i++) {
+        if(!isfinite(samples[i])) {
+            return false;
+        }
+        lb = std::min(lb, samples[i]);
+        ub = std::max(ub, samples[i]);
+    }
+    correctBoundaries(lb, ub);
+
+    if(nBins <= 0) {
+        nBins = (int)ceil(sqrt((double)samples.size()));
+        nBins = std::min(std::max(nBins, 1), DistEmpiricalMaxBins);
+    }
+    vector<double> edges(nBins + 1);
+    for(int i = 0; i < nBins; i++) {
+        edges[i] = lb + (ub - lb) * i / nBins;
+    }
+    edges[nBins] = ub;
+
+    vector<double> counts(nBins, 0.0);
+    double scale = nBins / (ub - lb);
+    for(size_t i = 0; i < samples.size(); i++) {
+        int bin = (int)((samples[i] - lb) * scale);
+        counts[std::min(std::max(bin, 0), nBins - 1)] += 1.0;
+    }
+    return defineHistogram(edges, counts);
+}
+
+bool EmpiricalDistribution::loadHistogram(const string& fileName)
+{
+    vector<double> values;
+    uint32_t n = 0;
+    bool valid;
+    if(readBinary(fileName, HistogramFile, values, n, valid)) {
+        if(!valid) {
+            return false;
+        }
+        vector<double> edges(values.begin(), values.begin() + n + 1);
+        vector<double> weights(values.begin() + n + 1, values.end());
+        return defineHistogram(edges, weights);
+    }
+
+    vector<vector<double> > rows;
+    if(!readText(fileName, rows) || rows.empty()) {
+        return false;
+    }
+    vector<double> edges(1, rows[0].size() == 3 ? rows[0][0] : 0.0);
+    vector<double> weights;
+    for(size_t i = 0; i < rows.size(); i++) {
+        if(rows[i].size() != 3) {
+            return false;
+        }
+        double lower = rows[i][0];
+        if(lower > edges.back()) {
+            // a gap
+            edges.push_back(lower);
+            weights.push_back(0.0);
+        } else if(lower < edges.back()) {
+            return false;
+        }
+        edges.push_back(rows[i][1]);
+        weights.push_back(rows[i][2]);
+    }
+    return defineHistogram(edges, weights);
+}
+
+bool EmpiricalDistribution::loadSamples(const string& fileName, int nBins)
+{
+    vector<double> values;
+    uint32_t n = 0;
+    bool valid;
+    if(readBinary(fileName, SamplesFile, values, n, valid)) {
+        return valid && defineSamples(values, nBins);
+    }
+
+    vector<vector<double> > rows;
+    if(!readText(fileName, rows)) {
+        return false;
+    }
+    values.clear();
+    for(size_t i = 0; i < rows.size(); i++) {
+        values.insert(values.end(), rows[i].begin(), rows[i].end());
+    }
+    return defineSamples(values, nBins);
+}
+
+bool EmpiricalDistribution::saveHistogram(const string& fileName) const
+{
+    EmpiricalHeader header;
+    memcpy(header.magic, EmpiricalMagic, sizeof(header.magic));
+    header.byteOrder = EmpiricalByteOrder;
+    header.version   = EmpiricalVersion;
+    header.kind      = HistogramFile;
+    header.n         = (uint32_t)m_probabilities.size();
+
+    std::ofstream ofs(fileName.c_str(), std::ofstream::out | std::ofstream::binary);
+    if(!ofs) {
+        return false;
+    }
+    ofs.write((const char*)&header, sizeof(header));
+    ofs.write((const char*)m_edges.data(), m_edges.size() * sizeof(double));
+    ofs.write((const char*)m_probabilities.data(),
+              m_probabilities.size() * sizeof(double));
+    return (bool)ofs;
+}
+
+void EmpiricalDistribution::defineSmoothing(bool smooth)
+{
+    if(m_smoothing != smooth) {
+        m_smoothing = smooth;
+        updateBins();
+    }
+}
+
+bool EmpiricalDistribution::isSmoothed() const
+{
+    return m_smoothing;
+}
+
+int EmpiricalDistribution::nBins() const
+{
+    return (int)m_probabilities.size();
+}
+
+const vector<double>& EmpiricalDistribution::edges() const
+{
+    return m_edges;
+}
+
+const vector<double>& EmpiricalDistribution::probabilities() const
+{
+    return m_probabilities;
+}
+
+double EmpiricalDistribution::transformUniform(double u)
+{
+    double v;
+    int i = m_alias.pick(u, v);
+    return m_edges[i] + binOffset(i, v);
+}
+
+void EmpiricalDistribution::sample(size_t n, double* out, RandomStream& rs)
+{
+    rs.fill(out, n);
+    for(size_t k=0; k<n; k++) {
+        double v;
+        int i = m_alias.pick(out[k], v);
+        out[k] = m_edges[i] + binOffset(i, v);
+    }
+}
+
+void EmpiricalDistribution::defineBoundaries(double lb, double ub)
+{
+    correctBoundaries(lb, ub);
+    double oldLb = m_edges.front();
+    double scale = (ub - lb) / (m_edges.back() - oldLb);
+    for(size_t i = 0; i < m_edges.size(); i++) {
+        m_edges[i] = lb + (m_edges[i] - oldLb) * scale;
+    }
+    m_edges.back() = ub;
+    m_lb = lb;
+    m_ub = ub;
+    updateBins();
+}
+
+void EmpiricalDistribution::generateZ()
+{
+    int n = nBins();
+    m_nSamples = 2 * n + 1;
+    m_z.resize(m_nSamples);
+    for(int i = 0; i < n; i++) {
+        m_z[2*i]   = m_edges[i];
+        m_z[2*i+1] = (m_edges[i] + m_edges[i+1]) / 2.0;
+    }
+    m_z[2*n] = m_edges[n];
+}
+
+void EmpiricalDistribution::generatePDF()
+{
+    // the grid may have been coarsened, so the bin of every point is found
+    m_pdf.resize(m_nSamples);
+    int n = nBins();
+    for(int k = 0; k < m_nSamples; k++) {
+        double z = m_z[k];
+        int i = (int)(std::upper_bound(m_edges.begin(), m_edges.end(), z)
+                      - m_edges.begin()) - 1;
+        i = std::min(std::max(i, 0), n - 1);
+        double w = m_edges[i+1] - m_edges[i];
+        double t = z - m_edges[i];
+        double p = m_density[i] + m_slope[i] * (t - w / 2.0);
+        if((t == 0.0) && (i > 0)) {
+            // an inner edge: the mean of the two sides
+            double wl = m_edges[i] - m_edges[i-1];
+            p = (p + m_density[i-1] + m_slope[i-1] * wl / 2.0) / 2.0;
+        }
+        m_pdf[k] = std::max(p, 0.0);
+    }
+}
+
+bool EmpiricalDistribution::generateCDF()
+{
+    m_cdf.resize(m_nSamples);
+    int n = nBins();
+    for(int k = 0; k < m_nSamples; k++) {
+        int i = (int)(std::upper_bound(m_edges.begin(), m_edges.end(), m_z[k])
+                      - m_edges.begin()) - 1;
+        i = std::min(std::max(i, 0), n - 1);
+        m_cdf[k] = std::min(m_cumulative[i] + binMass(i, m_z[k] - m_edges[i]),
+                            1.0);
+    }
+    m_cdf.front() = 0.0;
+    m_cdf.back()  = 1.0;
+    return true;
+}
+
+void EmpiricalDistribution::updateBins()
+{
+    int n = nBins();
+    m_density.resize(n);
+    m_slope.assign(n, 0.0);
+    m_cumulative.resize(n + 1);
+    m_cumulative[0] = 0.0;
+    for(int i = 0; i < n; i++) {
+        m_density[i]      = m_probabilities[i] / (m_edges[i+1] - m_edges[i]);
+        m_cumulative[i+1] = m_cumulative[i] + m_probabilities[i];
+    }
+
+    if(m_smoothing && (n > 1)) {
+        for(int i = 0; i < n; i++) {
+            // the slope between the neighbouring centres, one sided at the
+            // ends, limited to keep the density at the edges non-negative
+            int a = std::max(i - 1, 0);
+            int b = std::min(i + 1, n - 1);
+            double ca = (m_edges[a] + m_edges[a+1]) / 2.0;
+            double cb = (m_edges[b] + m_edges[b+1]) / 2.0;
+            double s  = (m_density[b] - m_density[a]) / (cb - ca);
+            double sMax = 2.0 * m_density[i] / (m_edges[i+1] - m_edges[i]);
+            m_slope[i] = std::min(std::max(s, -sMax), sMax);
+        }
+    }
+    m_updated = false;
+}
+
+double EmpiricalDistribution::binOffset(int i, double v) const
+{
+    double w = m_edges[i+1] - m_edges[i];
+    double s = m_slope[i];
+    if(s == 0.0) {
+        return v * w;
+    }
+    // the root of s/2*t^2 + left*t = v*mass, in its stable form
+    double left = m_density[i] - s * w / 2.0;
+    double q    = v * m_probabilities[i];
+    double den  = left + sqrt(std::max(left * left + 2.0 * s * q, 0.0));
+    if(!(den > 0.0)) {
+        return 0.0;
+    }
+    return std::min(2.0 * q / den, w);
+}
+
+double EmpiricalDistribution::binMass(int i, double t) const
+{
+    double w    = m_edges[i+1] - m_edges[i];
+    double left = m_density[i] - m_slope[i] * w / 2.0;
+    return left * t + m_slope[i] * t * t / 2.0;
+}
+
+} // namespace CODeM
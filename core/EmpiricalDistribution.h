@@ -0,0 +1,122 @@
+/****************************************************************************
+**
+** The MIT License (MIT)
+**
+** Copyright (c) 2016 The University of Sheffield (www.sheffield.ac.uk)
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in all
+** copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE
+**
+****************************************************************************/
+#ifndef EMPIRICALDISTRIBUTION_H
+#define EMPIRICALDISTRIBUTION_H
+
+#include <core/RandomDistributions.h>
+#include <core/utils/AliasTable.h>
+
+#include <string>
+#include <vector>
+
+namespace CODeM {
+
+/*  A distribution of measured data, given as a histogram or as raw samples
+ *  that are binned into one. Every sample picks a bin from an alias table
+ *  and a position within it from the same uniform value, in O(1) for any
+ *  number of bins. The density is constant within each bin, or with
+ *  smoothing linear, with its slope taken from the neighbouring bins and
+ *  limited to keep it non-negative. Smoothing keeps the mass of every bin.
+ *
+ *  Histogram files are text, with one "lower,upper,weight" row per bin in
+ *  ascending order; gaps between the bins have no weight. Sample files are
+ *  text with the values separated by commas or white space. In both, lines
+ *  starting with '#' and a leading header line are skipped. Either can also
+ *  be binary, in the byte order of the machine that wrote it:
+ *      char[8]  magic "CODeMEMP"
+ *      uint32   byte order mark 0x01020304
+ *      uint32   version
+ *      uint32   kind: 0 for a histogram, 1 for samples
+ *      uint32   number of bins or samples n
+ *      double   a histogram's n+1 edges and then its n weights, or the
+ *               n samples
+ *
+ *  A new distribution is uniform over [0,1]. Redefining the boundaries
+ *  scales the histogram to the new range. */
+class EmpiricalDistribution : public IDistribution
+{
+public:
+    EmpiricalDistribution();
+    EmpiricalDistribution(const std::vector<double>& edges,
+                          const std::vector<double>& weights);
+    virtual ~EmpiricalDistribution();
+
+    // Returns false, and keeps the current histogram, if the edges are not
+    // increasing, their number is not one more than that of the weights,
+    // or the weights are not valid for an AliasTable
+    bool defineHistogram(const std::vector<double>& edges,
+                         const std::vector<double>& weights);
+    // A histogram of nBins equal bins over the range of the samples. With
+    // nBins = 0 the square root rule is used, up to DistEmpiricalMaxBins.
+    bool defineSamples(const std::vector<double>& samples, int nBins = 0);
+
+    // Load a histogram or samples file, text or binary. Return false if the
+    // file cannot be read or does not hold a valid histogram.
+    bool loadHistogram(const std::string& fileName);
+    bool loadSamples(const std::string& fileName, int nBins = 0);
+    // Write the histogram as a binary file
+    bool saveHistogram(const std::string& fileName) const;
+
+    void defineSmoothing(bool smooth);
+    bool isSmoothed() const;
+
+    int                        nBins()         const;
+    const std::vector<double>& edges()         const;
+    // the weights of the bins, normalised
+    const std::vector<double>& probabilities() const;
+
+    using IDistribution::sample;
+    double transformUniform(double u);
+    void   sample(std::size_t n, double* out, Utils::RandomStream& rs);
+
+    void   defineBoundaries(double lb, double ub);
+
+    // The grid is the bin edges and centres, with the exact cdf there. The
+    // pdf at an edge is the mean of its two sides.
+    void generateZ();
+    void generatePDF();
+    bool generateCDF();
+
+private:
+    void   updateBins();
+    // The offset within bin i of the position v in [0,1] of its mass
+    double binOffset(int i, double v) const;
+    // The mass of bin i up to the offset t
+    double binMass(int i, double t) const;
+
+    std::vector<double> m_edges;
+    std::vector<double> m_probabilities;
+    std::vector<double> m_density;
+    std::vector<double> m_slope;
+    // the probabilities, accumulated from 0 at the first edge
+    std::vector<double> m_cumulative;
+    Utils::AliasTable   m_alias;
+    bool                m_smoothing;
+};
+
+} // namespace CODeM
+
+#endif // EMPIRICALDISTRIBUTION_H
@@ -0,0 +1,390 @@
+/****************************************************************************
+**
+** The MIT License (MIT)
+**
+** Copyright (c) 2016 The University of Sheffield (www.sheffield.ac.uk)
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in all
+** copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE
+**
+****************************************************************************/
+#include <core/PeakQuantileSurface.h>
+#include <core/RandomDistributions.h>
+#include <core/DistributionCache.h>
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using std::string;
+using std::vector;
+using std::size_t;
+
+namespace CODeM {
+
+namespace {
+
+const char     SurfaceMagic[8] = {'C', 'O', 'D', 'e', 'M', 'P', 'Q', 'S'};
+const uint32_t SurfaceByteOrder(0x01020304u);
+const uint32_t SurfaceVersion(1);
+
+struct SurfaceHeader
+{
+    char     magic[8];
+    uint32_t byteOrder;
+    uint32_t version;
+    uint32_t nTendency;
+    uint32_t nLocality;
+    uint32_t nQuantiles;
+    uint32_t reserved;
+    double   maxError;
+};
+
+// The grid value of index i out of n over [0,1]
+inline double gridValue(int i, int n)
+{
+    return (double)i / (n - 1);
+}
+
+// The k-th of n probabilities. They are at the centres of n equal intervals
+// of [0,1]: where a peak has negligible density the quantile changes
+// abruptly near 0 and 1, so these are not tabulated.
+inline double probability(double k, int n)
+{
+    return (k + 0.5) / n;
+}
+
+// The k-th quantiles of the four rows around a point, weighted by wl and wt
+inline double rowsValue(const double* q00, const double* q01,
+                        const double* q10, const double* q11,
+                        int k, double wl, double wt)
+{
+    double a0 = q00[k] + wl * (q01[k] - q00[k]);
+    double a1 = q10[k] + wl * (q11[k] - q10[k]);
+    return a0 + wt * (a1 - a0);
+}
+
+// The quantile at u in the end half-cell [0,p0], where the first tabulated
+// quantile q0 has the slope s: q0*(u/p0)^a goes to 0 with u, and a matches
+// the slope at p0, so the tail keeps its mass spread below q0.
+inline double tailQuantile(double u, double p0, double q0, double s)
+{
+    if(!(q0 > 0.0) || !(u > 0.0)) {
+        return 0.0;
+    }
+    double a = std::max(s * p0 / q0, 0.0);
+    return q0 * pow(u / p0, a);
+}
+
+// Splits the fractional index f into a cell of an n point grid and the
+// weight of its upper node. Beyond the grid the end values are used.
+inline int gridCell(double f, int n, double& w)
+{
+    if(!(f > 0.0)) {
+        w = 0.0;
+        return 0;
+    }
+    int i = (int)f;
+    if(i >= n - 1) {
+        w = 1.0;
+        return n - 2;
+    }
+    w = f - i;
+    return i;
+}
+
+// The exact quantiles of one peak distribution at the probabilities in u
+void peakQuantiles(double tendency, double locality,
+                   const vector<double>& u, double* out)
+{
+    PeakDistribution dist(tendency, locality);
+    dist.defineAdaptiveTolerance(0.0);
+    for(size_t k = 0; k < u.size(); k++) {
+        out[k] = dist.inverseCDF(u[k]);
+    }
+}
+
+} // namespace
+
+PeakQuantileSurface& PeakQuantileSurface::instance()
+{
+    static PeakQuantileSurface surface;
+    return surface;
+}
+
+PeakQuantileSurface::PeakQuantileSurface()
+    : m_data(0),
+      m_mapping(0),
+      m_mappedSize(0),
+      m_nTendency(0),
+      m_nLocality(0),
+      m_nQuantiles(0),
+      m_maxError(0.0)
+{
+
+}
+
+PeakQuantileSurface::~PeakQuantileSurface()
+{
+    unload();
+}
+
+bool PeakQuantileSurface::build(const string& fileName, int nTendency,
+                                int nLocality, int nQuantiles)
+{
+    if((nTendency < 2) || (nLocality < 2) || (nQuantiles < 2)) {
+        return false;
+    }
+
+    // The surface is of the exact distributions, not of the cached ones
+    DistributionCache& cache = DistributionCache::instance();
+    double cacheTol = cache.tolerance();
+    cache.defineTolerance(0.0);
+
+    size_t rowSize = (size_t)nQuantiles;
+    vector<double> u(rowSize);
+    for(int k = 0; k < nQuantiles; k++) {
+        u[k] = probability(k, nQuantiles);
+    }
+    vector<double> data((size_t)nTendency * nLocality * rowSize);
+    for(int i = 0; i < nTendency; i++) {
+        for(int j = 0; j < nLocality; j++) {
+            peakQuantiles(gridValue(i, nTendency), gridValue(j, nLocality), u,
+                          &data[((size_t)i * nLocality + j) * rowSize]);
+        }
+    }
+
+    // Multilinear interpolation is least accurate at the centres of the
+    // cells, so compare it there with the exact quantiles. The extrapolated
+    // tails beyond the first and last probabilities are checked at fractions
+    // of the end half-cells, down to 0 and 1.
+    const double tailFractions[] = {0.5, 0.1, 0.01, 1.0e-4, 0.0};
+    const int    nTail = sizeof(tailFractions) / sizeof(tailFractions[0]);
+    vector<double> uCentre;
+    uCentre.reserve(rowSize - 1 + 2 * nTail);
+    for(int t = 0; t < nTail; t++) {
+        double uTail = tailFractions[t] * probability(0, nQuantiles);
+        uCentre.push_back(uTail);
+        uCentre.push_back(1.0 - uTail);
+    }
+    for(int k = 1; k < nQuantiles; k++) {
+        uCentre.push_back(probability(k - 0.5, nQuantiles));
+    }
+
+    double maxError = 0.0;
+    vector<double> exact(uCentre.size());
+    PeakQuantileSurface surface;
+    surface.m_data       = data.data();
+    surface.m_nTendency  = nTendency;
+    surface.m_nLocality  = nLocality;
+    surface.m_nQuantiles = nQuantiles;
+    for(int i = 0; i < nTendency - 1; i++) {
+        for(int j = 0; j < nLocality - 1; j++) {
+            double tendency = (i + 0.5) / (nTendency - 1);
+            double locality = (j + 0.5) / (nLocality - 1);
+            peakQuantiles(tendency, locality, uCentre, exact.data());
+            for(size_t k = 0; k < uCentre.size(); k++) {
+                double approx = surface.quantile(tendency, locality, uCentre[k]);
+                maxError = std::max(maxError, fabs(approx - exact[k]));
+            }
+        }
+    }
+    surface.m_data = 0;
+
+    cache.defineTolerance(cacheTol);
+
+    SurfaceHeader header;
+    memcpy(header.magic, SurfaceMagic, sizeof(header.magic));
+    header.byteOrder  = SurfaceByteOrder;
+    header.version    = SurfaceVersion;
+    header.nTendency  = (uint32_t)nTendency;
+    header.nLocality  = (uint32_t)nLocality;
+    header.nQuantiles = (uint32_t)nQuantiles;
+    header.reserved   = 0;
+    header.maxError   = maxError;
+
+    std::ofstream ofs(fileName.c_str(), std::ofstream::out | std::ofstream::binary);
+    if(!ofs) {
+        return false;
+    }
+    ofs.write((const char*)&header, sizeof(header));
+    ofs.write((const char*)data.data(), data.size() * sizeof(double));
+    return (bool)ofs;
+}
+
+bool PeakQuantileSurface::load(const string& fileName)
+{
+    unload();
+
+    const char* bytes = 0;
+    size_t      size  = 0;
+#ifndef _WIN32
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if(fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if((fstat(fd, &st) == 0) && (st.st_size >= (off_t)sizeof(SurfaceHeader))) {
+        void* mapping = mmap(0, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if(mapping != MAP_FAILED) {
+            m_mapping    = mapping;
+            m_mappedSize = (size_t)st.st_size;
+            bytes = (const char*)mapping;
+            size  = m_mappedSize;
+        }
+    }
+    close(fd);
+#else
+    std::ifstream ifs(fileName.c_str(), std::ifstream::in | std::ifstream::binary);
+    if(ifs) {
+        ifs.seekg(0, std::ifstream::end);
+        size = (size_t)ifs.tellg();
+        ifs.seekg(0, std::ifstream::beg);
+        m_buffer.resize((size + sizeof(double) - 1) / sizeof(double));
+        if(ifs.read((char*)m_buffer.data(), size)) {
+            bytes = (const char*)m_buffer.data();
+        }
+    }
+#endif
+    if(bytes == 0) {
+        unload();
+        return false;
+    }
+
+    SurfaceHeader header;
+    bool valid = size >= sizeof(header);
+    if(valid) {
+        memcpy(&header, bytes, sizeof(header));
+        valid = (memcmp(header.magic, SurfaceMagic, sizeof(header.magic)) == 0)
+                && (header.byteOrder == SurfaceByteOrder)
+                && (header.version   == SurfaceVersion)
+                && (header.nTendency >= 2) && (header.nLocality >= 2)
+                && (header.nQuantiles >= 2);
+    }
+    if(valid) {
+        size_t nValues = (size_t)header.nTendency * header.nLocality
+                * header.nQuantiles;
+        valid = (size - sizeof(header)) / sizeof(double) >= nValues;
+    }
+    if(!valid) {
+        unload();
+        return false;
+    }
+
+    m_data       = (const double*)(bytes + sizeof(header));
+    m_nTendency  = (int)header.nTendency;
+    m_nLocality  = (int)header.nLocality;
+    m_nQuantiles = (int)header.nQuantiles;
+    m_maxError   = header.maxError;
+    return true;
+}
+
+void PeakQuantileSurface::unload()
+{
+#ifndef _WIN32
+    if(m_mapping != 0) {
+        munmap(m_mapping, m_mappedSize);
+    }
+#endif
+    m_buffer.clear();
+    m_data       = 0;
+    m_mapping    = 0;
+    m_mappedSize = 0;
+    m_nTendency  = 0;
+    m_nLocality  = 0;
+    m_nQuantiles = 0;
+    m_maxError   = 0.0;
+}
+
+bool PeakQuantileSurface::isLoaded() const
+{
+    return m_data != 0;
+}
+
+int PeakQuantileSurface::nTendency() const
+{
+    return m_nTendency;
+}
+
+int PeakQuantileSurface::nLocality() const
+{
+    return m_nLocality;
+}
+
+int PeakQuantileSurface::nQuantiles() const
+{
+    return m_nQuantiles;
+}
+
+double PeakQuantileSurface::maxError() const
+{
+    return m_maxError;
+}
+
+double PeakQuantileSurface::quantile(double tendency, double locality,
+                                     double u) const
+{
+    double wt, wl, wu;
+    int i = gridCell(tendency * (m_nTendency - 1), m_nTendency,  wt);
+    int j = gridCell(locality * (m_nLocality - 1), m_nLocality,  wl);
+
+    int    nq      = m_nQuantiles;
+    size_t rowSize = (size_t)nq;
+    const double* q00 = m_data + ((size_t)i * m_nLocality + j) * rowSize;
+    const double* q01 = q00 + rowSize;
+    const double* q10 = q00 + (size_t)m_nLocality * rowSize;
+    const double* q11 = q10 + rowSize;
+
+    // the end half-cells are extrapolated towards 0 and 1
+    double f = u * nq - 0.5;
+    if(!(f >= 0.0)) {
+        double q0 = rowsValue(q00, q01, q10, q11, 0, wl, wt);
+        double q1 = rowsValue(q00, q01, q10, q11, 1, wl, wt);
+        return tailQuantile(u, probability(0, nq), q0, (q1 - q0) * nq);
+    }
+    if(f > nq - 1) {
+        double q0 = rowsValue(q00, q01, q10, q11, nq - 1, wl, wt);
+        double q1 = rowsValue(q00, q01, q10, q11, nq - 2, wl, wt);
+        return 1.0 - tailQuantile(1.0 - u, probability(0, nq), 1.0 - q0,
+                                  (q0 - q1) * nq);
+    }
+
+    int k = gridCell(f, nq, wu);
+    q00 += k;
+    q01 += k;
+    q10 += k;
+    q11 += k;
+    double a00 = q00[0] + wu * (q00[1] - q00[0]);
+    double a01 = q01[0] + wu * (q01[1] - q01[0]);
+    double a10 = q10[0] + wu * (q10[1] - q10[0]);
+    double a11 = q11[0] + wu * (q11[1] - q11[0]);
+    double a0  = a00 + wl * (a01 - a00);
+    double a1  = a10 + wl * (a11 - a10);
+    return a0 + wt * (a1 - a0);
+}
+
+} // namespace CODeM
@@ -0,0 +1,95 @@
+/****************************************************************************
+**
+** The MIT License (MIT)
+**
+** Copyright (c) 2016 The University of Sheffield (www.sheffield.ac.uk)
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in all
+** copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE
+**
+****************************************************************************/
+#ifndef PEAKQUANTILESURFACE_H
+#define PEAKQUANTILESURFACE_H
+
+#include <core/CODeMGlobal.h>
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace CODeM {
+
+/*  The inverse cdf of PeakDistribution on [0,1], tabulated offline over a
+ *  grid of tendency and locality values, each at equally spaced
+ *  probabilities. A loaded surface replaces the construction of the peak
+ *  tables: every sample becomes an interpolation between the eight
+ *  neighbouring entries of the grid. Below the first and above the last
+ *  probability the quantile is extrapolated towards 0 and 1.
+ *
+ *  File layout, in the byte order of the machine that wrote it:
+ *      char[8]  magic "CODeMPQS"
+ *      uint32   byte order mark 0x01020304
+ *      uint32   version
+ *      uint32   number of tendency, locality and probability values
+ *      uint32   reserved
+ *      double   maximum interpolation error, measured at the cell centres
+ *               and in the extrapolated tails
+ *      double   quantiles[tendency][locality][probability]
+ *
+ *  The file is memory mapped read-only where the platform supports it. */
+class PeakQuantileSurface
+{
+public:
+    static PeakQuantileSurface& instance();
+
+    // Tabulate the surface and write it to fileName. Returns false if the
+    // grid is too small or the file cannot be written.
+    static bool build(const std::string& fileName, int nTendency,
+                      int nLocality, int nQuantiles);
+
+    bool   load(const std::string& fileName);
+    void   unload();
+    bool   isLoaded()   const;
+
+    int    nTendency()  const;
+    int    nLocality()  const;
+    int    nQuantiles() const;
+    double maxError()   const;
+
+    // The quantile at probability u of the peak distribution on [0,1]
+    double quantile(double tendency, double locality, double u) const;
+
+private:
+    PeakQuantileSurface();
+    ~PeakQuantileSurface();
+    PeakQuantileSurface(const PeakQuantileSurface&);
+    PeakQuantileSurface& operator=(const PeakQuantileSurface&);
+
+    const double*       m_data;
+    void*               m_mapping;
+    std::size_t         m_mappedSize;
+    std::vector<double> m_buffer; // when the file cannot be mapped
+    int                 m_nTendency;
+    int                 m_nLocality;
+    int                 m_nQuantiles;
+    double              m_maxError;
+};
+
+} // namespace CODeM
+
+#endif // PEAKQUANTILESURFACE_H
@@ -24,73 +24,156 @@
 **
 ****************************************************************************/
 #include <core/RandomDistributions.h>
+#include <core/DistributionCache.h>
+#include <core/PeakQuantileSurface.h>
 #include <core/utils/LinearInterpolator.h>
-#include <random>
-#include <complex>
+#include <core/utils/FFT.h>
+#include <core/utils/PrefixScan.h>
+#include <core/utils/SpecialFunctions.h>
 #include <math.h>
 #include <algorithm>
+#include <cfloat>
+#include <atomic>
+#include <functional>
+#include <queue>
 
 
-using CODeM::Utils::LinearInterpolator;
+using CODeM::Utils::interpolateSorted;
+using CODeM::Utils::RandomStream;
 using namespace std;
 
 namespace CODeM {
 
+// Distribution types in DistributionKey
+enum {
+    PeakDistributionKey = 1
+};
+
+namespace {
+double                              defaultAdaptiveTol(0.0);
+std::atomic<unsigned long long>     nGridPoints(0);
+std::atomic<unsigned long long>     nUniformGridPoints(0);
+
+// The truncated exponential with the pdf proportional to exp(-r*t) over
+// [0,w]. A negative rate is the mirror image of the positive one.
+double exponentialQuantile(double r, double w, double u)
+{
+    if(fabs(r * w) < 1e-12) {
+        return u * w;
+    } else if(r < 0.0) {
+        return w - exponentialQuantile(-r, w, 1.0 - u);
+    }
+    return -log1p(u * expm1(-r * w)) / r;
+}
+
+double exponentialCDF(double r, double w, double t)
+{
+    if(fabs(r * w) < 1e-12) {
+        return t / w;
+    } else if(r < 0.0) {
+        return 1.0 - exponentialCDF(-r, w, w - t);
+    }
+    return expm1(-r * t) / expm1(-r * w);
+}
+
+double exponentialPDF(double r, double w, double t)
+{
+    if(fabs(r * w) < 1e-12) {
+        return 1.0 / w;
+    } else if(r < 0.0) {
+        return exponentialPDF(-r, w, w - t);
+    }
+    return -r * exp(-r * t) / expm1(-r * w);
+}
+}
+
 /// IDISTRIBUTION
 IDistribution::IDistribution()
     : m_lb(0.0),
       m_ub(1.0),
-      m_dz(1.0),
       m_nSamples(0),
-      m_quantileInterpolator(0),
-      m_updated(false)
+      m_updated(false),
+      m_dz(1.0),
+      m_adaptiveTol(defaultAdaptiveTol),
+      m_nUniformSamples(0)
 {
 
 }
 
 IDistribution::~IDistribution()
 {
-    if(m_quantileInterpolator != 0) {
-        delete m_quantileInterpolator;
-    }
+
 }
 
 double IDistribution::sample()
+{
+    return sample(Utils::globalRandomStream());
+}
+
+double IDistribution::sample(RandomStream& rs)
+{
+    return transformUniform(rs.uniform());
+}
+
+void IDistribution::sample(size_t n, double* out, RandomStream& rs)
 {
     if(!m_updated) {
         computeDistribution();
     }
 
-    // A value between 0-1: 0==>lb , 1==>ub
-    double sample = m_quantileInterpolator->interpolate(randUni());
-    return sample;
+    rs.fill(out, n);
+    quantiles(n, out);
+}
+
+const vector<double>& IDistribution::zSamples()
+{
+    if(!m_updated) {
+        computeDistribution();
+    }
+
+    return m_table->z;
 }
 
-vector<double> IDistribution::zSamples()
+const vector<double>& IDistribution::pdf()
 {
     if(!m_updated) {
         computeDistribution();
     }
 
-    return m_z;
+    return m_table->pdf;
 }
 
-vector<double> IDistribution::pdf()
+const vector<double>& IDistribution::cdf()
 {
     if(!m_updated) {
         computeDistribution();
     }
 
-    return m_pdf;
+    return m_table->cdf;
 }
 
-vector<double> IDistribution::cdf()
+shared_ptr<const DistributionTable> IDistribution::table()
 {
     if(!m_updated) {
         computeDistribution();
     }
 
-    return m_cdf;
+    return m_table;
+}
+
+double IDistribution::inverseCDF(double u)
+{
+    if(!m_updated) {
+        computeDistribution();
+    }
+
+    return quantile(u);
+}
+
+double IDistribution::transformUniform(double u)
+{
+    // A value between 0-1: 0==>lb , 1==>ub
+    return inverseCDF(u);
 }
 
 void IDistribution::defineResolution(double dz)
@@ -110,15 +193,7 @@ double IDistribution::resolution() const
 
 void IDistribution::defineBoundaries(double lb, double ub)
 {
-    if(lb >= ub) {
-        if(lb == 0) {
-            ub = DistMinInterval;
-        } else if(lb > 0) {
-            ub = lb * (1 + DistMinInterval);
-        } else {
-            lb = ub * (1 + DistMinInterval);
-        }
-    }
+    correctBoundaries(lb, ub);
 
     double oldRange = m_ub - m_lb;
     double newRange = ub - lb;
@@ -132,6 +207,64 @@ void IDistribution::defineBoundaries(double lb, double ub)
     m_updated = false;
 }
 
+void IDistribution::defineAdaptiveTolerance(double tol)
+{
+    if(tol < 0.0) {
+        tol = 0.0;
+    }
+    if(tol != m_adaptiveTol) {
+        m_updated = false;
+    }
+    m_adaptiveTol = tol;
+}
+
+double IDistribution::adaptiveTolerance() const
+{
+    return m_adaptiveTol;
+}
+
+int IDistribution::nSamples()
+{
+    if(!m_updated) {
+        computeDistribution();
+    }
+
+    return m_nSamples;
+}
+
+void IDistribution::defineDefaultAdaptiveTolerance(double tol)
+{
+    defaultAdaptiveTol = (tol > 0.0) ? tol : 0.0;
+}
+
+double IDistribution::defaultAdaptiveTolerance()
+{
+    return defaultAdaptiveTol;
+}
+
+unsigned long long IDistribution::gridPoints()
+{
+    return nGridPoints;
+}
+
+unsigned long long IDistribution::uniformGridPoints()
+{
+    return nUniformGridPoints;
+}
+
+void IDistribution::correctBoundaries(double& lb, double& ub)
+{
+    if(lb >= ub) {
+        if(lb == 0) {
+            ub = DistMinInterval;
+        } else if(lb > 0) {
+            ub = lb * (1 + DistMinInterval);
+        } else {
+            lb = ub * (1 + DistMinInterval);
+        }
+    }
+}
+
 double IDistribution::lowerBound() const
 {
     return m_lb;
@@ -144,65 +277,228 @@ double IDistribution::upperBound() const
 
 void IDistribution::computeDistribution()
 {
+    DistributionCache& cache = DistributionCache::instance();
+    DistributionKey key;
+    bool cached = quantiseForCache(key) && cache.isEnabled();
+    m_table.reset();
+    if(cached) {
+        shared_ptr<const DistributionTable> table = cache.find(key);
+        if(table) {
+            m_table    = table;
+            m_nSamples = (int)table->z.size();
+            m_updated  = true;
+            return;
+        }
+    }
+
+    // build in the buffers of the previous table, unless it is shared
+    shared_ptr<DistributionTable> table;
+    if(m_ownTable && (m_ownTable.use_count() == 1)) {
+        table.swap(m_ownTable);
+        m_z.swap(table->z);
+        m_pdf.swap(table->pdf);
+        m_cdf.swap(table->cdf);
+    } else {
+        m_ownTable.reset();
+        table.reset(new DistributionTable);
+    }
+
     m_z.clear();
     m_pdf.clear();
     m_cdf.clear();
+    m_nUniformSamples = 0;
 
     generateZ();
+    if(m_nUniformSamples == 0) {
+        m_nUniformSamples = m_nSamples;
+    }
     generatePDF();
-    calculateCDF();
-
-    if(m_quantileInterpolator == 0) {
-        m_quantileInterpolator = new LinearInterpolator(m_cdf, m_z);
-    } else {
-        m_quantileInterpolator->defineXY(m_cdf, m_z);
+    if(m_adaptiveTol > 0.0) {
+        coarsenGrid();
+    }
+    if(!generateCDF()) {
+        calculateCDF();
+    }
+    nGridPoints        += m_nSamples;
+    nUniformGridPoints += m_nUniformSamples;
+
+    // the build buffers are moved into the table, which is not changed
+    // while it is shared
+    table->z.swap(m_z);
+    table->pdf.swap(m_pdf);
+    table->cdf.swap(m_cdf);
+    table->guide.define(table->cdf);
+    m_table    = table;
+    m_ownTable = table;
+
+    if(cached) {
+        cache.insert(key, table);
     }
 
     m_updated = true;
 }
 
+bool IDistribution::quantiseForCache(DistributionKey&)
+{
+    return false;
+}
+
+bool IDistribution::generateCDF()
+{
+    return false;
+}
+
 void IDistribution::calculateCDF()
 {
-    m_cdf.assign(m_nSamples, 0.0);
-    double cur  = 0.0;
-    double next = 0.0;
-    for(int i=0; i<m_nSamples-1; i++) {
-        cur  = m_pdf[i];
-        next = m_pdf[i+1];
-        m_cdf[i+1] = m_cdf[i] + (cur+next)/2.0 * (m_z[i+1] - m_z[i]);
+    m_cdf.resize(m_nSamples);
+    if(m_nSamples < 2) {
+        return;
+    }
+
+    double factor;
+    if(m_nSamples >= DistBlockedScanMinSamples) {
+        factor = Utils::blockedTrapezoidScan(m_z.data(), m_pdf.data(),
+                                             m_nSamples, m_cdf.data());
+    } else {
+        factor = Utils::trapezoidScan(m_z.data(), m_pdf.data(),
+                                      m_nSamples, m_cdf.data());
     }
 
     // normalise
-    double factor = m_cdf.back();
     if(factor == 1.0) {
         return;
     } else if(factor == 0.0) {
-        double probability = 1.0/(m_ub - m_lb);
-        m_pdf.assign(m_nSamples, probability);
-        calculateCDF();
+        // no mass: uniform over the grid, with a linear cdf
+        double z0    = m_z.front();
+        double range = m_z.back() - z0;
+        m_pdf.assign(m_nSamples, 1.0 / range);
+        for(int i=0; i<m_nSamples; i++) {
+            m_cdf[i] = (m_z[i] - z0) / range;
+        }
+        m_cdf.back() = 1.0;
     } else {
-//        for(int i=0; i<m_cdf.size(); i++) {
-//            m_pdf[i] /= factor;
-//            m_cdf[i] /= factor;
-//        }
-        // Try this instead. TODO: remove the comment if it works
-        transform(m_pdf.begin(), m_pdf.end(), m_pdf.begin(),
-                  [factor](double p){return p/factor;});
-        transform(m_cdf.begin(), m_cdf.end(), m_cdf.begin(),
-                  [factor](double p){return p/factor;});
+        double* pdf = m_pdf.data();
+        double* cdf = m_cdf.data();
+        for(int i=0; i<m_nSamples; i++) {
+            pdf[i] /= factor;
+            cdf[i] /= factor;
+        }
     }
 }
 
+void IDistribution::coarsenGrid()
+{
+    if(m_nSamples < 3) {
+        return;
+    }
+    // the cdf of the fine grid, not normalised
+    vector<double> c(m_nSamples, 0.0);
+    for(int i=0; i<m_nSamples-1; i++) {
+        c[i+1] = c[i] + (m_pdf[i]+m_pdf[i+1])/2.0 * (m_z[i+1] - m_z[i]);
+    }
+    double pMax = *max_element(m_pdf.begin(), m_pdf.end());
+    if((pMax <= 0.0) || (c.back() <= 0.0)) {
+        return;
+    }
+    // The samples interpolate the cdf linearly, and pdf() the pdf, so both
+    // are kept within the tolerance
+    double pTol = m_adaptiveTol * pMax;
+    double cTol = m_adaptiveTol * c.back();
+    double range = m_z.back() - m_z.front();
+
+    // Split every interval at its worst interpolated point until the
+    // interpolation between the kept points is within the tolerance
+    vector<char> keep(m_nSamples, 0);
+    keep[0] = keep[m_nSamples-1] = 1;
+    vector<pair<int, int> > intervals(1, make_pair(0, m_nSamples - 1));
+    while(!intervals.empty()) {
+        int a = intervals.back().first;
+        int b = intervals.back().second;
+        intervals.pop_back();
+
+        double dz     = m_z[b] - m_z[a];
+        double pSlope = (m_pdf[b] - m_pdf[a]) / dz;
+        double cSlope = (c[b] - c[a]) / dz;
+        double maxErr = 1.0;
+        int    worst  = -1;
+        for(int i = a+1; i < b; i++) {
+            double h    = m_z[i] - m_z[a];
+            double pErr = fabs(m_pdf[i] - m_pdf[a] - pSlope * h) / pTol;
+            double cErr = fabs(c[i] - c[a] - cSlope * h) / cTol;
+            double err  = max(pErr, cErr);
+            if(err > maxErr) {
+                maxErr = err;
+                worst  = i;
+            }
+        }
+        // the cdf of the kept points is integrated again, so the error of
+        // the area of every interval is bounded by its share of the tolerance
+        double area = (m_pdf[a] + m_pdf[b]) / 2.0 * dz;
+        if((worst < 0) && (b - a > 1) &&
+                (fabs(area - (c[b] - c[a])) > cTol * dz / range)) {
+            worst = (a + b) / 2;
+        }
+        if(worst >= 0) {
+            keep[worst] = 1;
+            intervals.push_back(make_pair(a, worst));
+            intervals.push_back(make_pair(worst, b));
+        }
+    }
+
+    int n = 0;
+    for(int i = 0; i < m_nSamples; i++) {
+        if(keep[i]) {
+            m_z[n]   = m_z[i];
+            m_pdf[n] = m_pdf[i];
+            n++;
+        }
+    }
+    m_nSamples = n;
+    m_z.resize(n);
+    m_pdf.resize(n);
+}
+
+void IDistribution::resetBase()
+{
+    m_lb          = 0.0;
+    m_ub          = 1.0;
+    m_dz          = 1.0;
+    m_adaptiveTol = defaultAdaptiveTol;
+    m_updated     = false;
+}
+
 void IDistribution::generateEquallySpacedZ()
 {
     m_nSamples = (int)((m_ub - m_lb) / m_dz) + 1;
+    m_nUniformSamples = m_nSamples;
+    // The adaptive grid starts from a finer one and coarsens it. A power of
+    // two number of intervals keeps transform based pdfs cheap.
+    double dz = m_dz;
+    if(m_adaptiveTol > 0.0) {
+        int nIntervals = 1;
+        while(nIntervals < (m_nSamples - 1) * DistAdaptiveRefinement) {
+            nIntervals *= 2;
+        }
+        m_nSamples = nIntervals + 1;
+        dz = (m_ub - m_lb) / nIntervals;
+    }
     m_z.resize(m_nSamples);
     double zz = m_lb;
-    for(int i = 0; i < m_z.size() - 1; i++) {
+    for(int i = 0; i < m_nSamples - 1; i++) {
         m_z[i] = zz;
-        zz += m_dz;
+        zz += dz;
     }
-    m_z[m_z.size() - 1] = m_ub;
+    m_z[m_nSamples - 1] = m_ub;
+}
+
+double IDistribution::quantile(double u) const
+{
+    return m_table->quantile(u);
+}
+
+void IDistribution::quantiles(size_t n, double* u) const
+{
+    m_table->quantiles(n, u);
 }
 
 /// UNIFORM DISTRIBUTION
@@ -222,9 +518,26 @@ UniformDistribution::~UniformDistribution()
 
 }
 
-double UniformDistribution::sample()
+void UniformDistribution::reset(double lb, double ub)
 {
-    return m_lb + randUni() * (m_ub - m_lb);
+    resetBase();
+    defineBoundaries(lb, ub);
+    defineResolution(m_ub - m_lb);
+}
+
+double UniformDistribution::transformUniform(double u)
+{
+    return m_lb + u * (m_ub - m_lb);
+}
+
+void UniformDistribution::sample(size_t n, double* out, RandomStream& rs)
+{
+    rs.fill(out, n);
+    double lb    = m_lb;
+    double range = m_ub - m_lb;
+    for(size_t i=0; i<n; i++) {
+        out[i] = lb + out[i] * range;
+    }
 }
 
 void UniformDistribution::generateZ()
@@ -257,9 +570,16 @@ LinearDistribution::~LinearDistribution()
 
 }
 
-double LinearDistribution::sample()
+void LinearDistribution::reset(double lb, double ub, bool ascend)
+{
+    resetBase();
+    m_ascend = ascend;
+    defineBoundaries(lb, ub);
+    defineResolution((m_ub-m_lb) / 2.0);
+}
+
+double LinearDistribution::transformUniform(double r)
 {
-    double r = randUni();
     double samp;
     if(m_ascend) {
         samp = m_lb + sqrt(r) * (m_ub - m_lb);
@@ -269,6 +589,23 @@ double LinearDistribution::sample()
     return samp;
 }
 
+void LinearDistribution::sample(size_t n, double* out, RandomStream& rs)
+{
+    rs.fill(out, n);
+    double lb    = m_lb;
+    double ub    = m_ub;
+    double range = m_ub - m_lb;
+    if(m_ascend) {
+        for(size_t i=0; i<n; i++) {
+            out[i] = lb + sqrt(out[i]) * range;
+        }
+    } else {
+        for(size_t i=0; i<n; i++) {
+            out[i] = ub - sqrt(1 - out[i]) * range;
+        }
+    }
+}
+
 void LinearDistribution::generateZ()
 {
     generateEquallySpacedZ();
@@ -307,14 +644,28 @@ void LinearDistribution::defineAscend(bool a)
 }
 
 /// PEAK DISTRIBUTION
+namespace {
+
+// The grid resolution of a peak distribution with the given locality
+double peakResolution(double locality)
+{
+    return 1.0/(locality+0.1)/(DistNSamples-1);
+}
+
+} // namespace
+
 PeakDistribution::PeakDistribution()
     : m_tendency(0.5),
-      m_locality(1.0)
+      m_locality(1.0),
+      m_genTendency(0.5),
+      m_genLocality(1.0),
+      m_seriesEvaluation(AutoSeries)
 {
     defineResolution(1.0 / (DistNSamples - 1));
 }
 
 PeakDistribution::PeakDistribution(double tendency, double locality)
+    : m_seriesEvaluation(AutoSeries)
 {
     defineTendencyAndLocality(tendency, locality);
 }
@@ -324,6 +675,40 @@ PeakDistribution::~PeakDistribution()
 
 }
 
+void PeakDistribution::reset(double tendency, double locality)
+{
+    resetBase();
+    m_seriesEvaluation = AutoSeries;
+    defineTendencyAndLocality(tendency, locality);
+}
+
+double PeakDistribution::transformUniform(double u)
+{
+    const PeakQuantileSurface& surface = PeakQuantileSurface::instance();
+    if(!surface.isLoaded()) {
+        return IDistribution::transformUniform(u);
+    }
+
+    // the shape of the distribution scales with its range
+    double q = surface.quantile(m_tendency, m_locality, u);
+    return m_lb + q * (m_ub - m_lb);
+}
+
+void PeakDistribution::sample(size_t n, double* out, RandomStream& rs)
+{
+    const PeakQuantileSurface& surface = PeakQuantileSurface::instance();
+    if(!surface.isLoaded()) {
+        IDistribution::sample(n, out, rs);
+        return;
+    }
+
+    rs.fill(out, n);
+    double Lz = m_ub - m_lb;
+    for(size_t i=0; i<n; i++) {
+        out[i] = m_lb + Lz * surface.quantile(m_tendency, m_locality, out[i]);
+    }
+}
+
 void PeakDistribution::defineTendencyAndLocality(double tendency, double locality)
 {
     if(tendency < 0.0) {
@@ -341,7 +726,9 @@ void PeakDistribution::defineTendencyAndLocality(double tendency, double localit
 
     m_locality = locality;
 
-    defineResolution(1.0/(m_locality+0.1)/(DistNSamples-1));
+    m_genTendency = m_tendency;
+    m_genLocality = m_locality;
+    defineResolution(peakResolution(m_locality));
 }
 
 double PeakDistribution::tendency() const
@@ -354,6 +741,47 @@ double PeakDistribution::locality() const
     return m_locality;
 }
 
+void PeakDistribution::defineSeriesEvaluation(SeriesEvaluation method)
+{
+    if(m_seriesEvaluation != method) {
+        m_updated = false;
+    }
+    m_seriesEvaluation = method;
+}
+
+PeakDistribution::SeriesEvaluation PeakDistribution::seriesEvaluation() const
+{
+    return m_seriesEvaluation;
+}
+
+bool PeakDistribution::quantiseForCache(DistributionKey& key)
+{
+    DistributionCache& cache = DistributionCache::instance();
+    bool   cached   = cache.isEnabled();
+    double tendency = cached ? cache.quantise(m_tendency) : m_tendency;
+    double locality = cached ? cache.quantise(m_locality) : m_locality;
+    // The table is built from the snapped parameters, and its resolution
+    // follows the snapped locality so nearby parameters share the same grid.
+    // tendency() and locality() keep the defined values.
+    if(locality != m_genLocality) {
+        defineResolution(peakResolution(locality));
+    }
+    m_genTendency = tendency;
+    m_genLocality = locality;
+    if(!cached) {
+        return false;
+    }
+
+    key.type      = PeakDistributionKey;
+    key.params[0] = tendency;
+    key.params[1] = locality;
+    key.params[2] = m_lb;
+    key.params[3] = m_ub;
+    key.params[4] = resolution();
+    key.params[5] = adaptiveTolerance();
+    return true;
+}
+
 void PeakDistribution::generateZ()
 {
     generateEquallySpacedZ();
@@ -363,105 +791,670 @@ void PeakDistribution::generatePDF()
 {
     m_pdf.resize(m_nSamples);
 
-    double shift = PI * m_tendency;
-    double N = DistPeakMinN + m_locality
+    // psiN = sum_n cNn * exp(-j*shift*(n+0.5)) * An*sin(n*theta). The common
+    // phase exp(-j*shift/2) does not change |psiN|^2 and is left out.
+    vector<complex<double> >& coeffs = m_coeffs;
+    seriesCoefficients(coeffs);
+
+    bool useTransform = false;
+    if(m_seriesEvaluation == TransformSeries) {
+        useTransform = true;
+    } else if((m_seriesEvaluation == AutoSeries) && isEquallySpaced()) {
+        // one update per basis function and grid point, against a transform
+        // of twice the number of intervals
+        double directCost    = (double)coeffs.size() * m_nSamples;
+        double transformCost = Utils::fftCost(2 * (m_nSamples - 1))
+                + coeffs.size() + m_nSamples;
+        useTransform = transformCost < directCost;
+    }
+
+    if(!useTransform || !transformSeries(coeffs)) {
+        directSeries(coeffs);
+    }
+
+    // the eigenfunctions vanish at the boundaries
+    m_pdf[0] = 0.0;
+    m_pdf[m_nSamples-1] = 0.0;
+}
+
+void PeakDistribution::seriesCoefficients(vector<complex<double> >& coeffs) const
+{
+    double shift = PI * m_genTendency;
+    double N = DistPeakMinN + m_genLocality
             * (DistPeakMaxN - DistPeakMinN);
-    vector<complex<double> > psiN(m_nSamples, complex<double>(0, 0));
 
     double nMax = max(3*N, DistPeakMinNBasisFunc);
     nMax = min(nMax, DistPeakMaxNBasisFunc);
+
+    coeffs.clear();
+    coeffs.reserve((size_t)nMax);
+
+    // Poisson weights: cNn^2 = N^n * exp(-N) / n!
+    double          cNn   = sqrt(N * exp(-N));
+    complex<double> step  = polar(1.0, -shift);
+    complex<double> phase = step;
     for(int n = 1; n <= nMax; n++) {
-        double cNn = sqrt( (pow(N, n) * exp(-N) / factorial(n)));
-        vector<double> psi = eigenFunction(n);
+        coeffs.push_back(cNn * phase);
+
+        // The basis is orthonormal, so dropping the terms after n changes
+        // psiN by at most sqrt(tail) in the 2-norm. Past the mode the tail of
+        // the Poisson weights is bounded by a geometric series.
+        double pNext = cNn * cNn * N / (n + 1);
+        if((n + 2 > N) && (pNext / (1.0 - N / (n + 2)) < DistPeakTruncationTol)) {
+            break;
+        }
+
+        cNn   *= sqrt(N / (n + 1));
+        phase *= step;
+    }
+}
+
+void PeakDistribution::directSeries(const vector<complex<double> >& coeffs)
+{
+    double Lz = m_ub - m_lb;
+    m_work.assign(5 * (size_t)m_nSamples, 0.0);
+    double* twoCos  = m_work.data();
+    double* sinPrev = twoCos  + m_nSamples;
+    double* sinCur  = sinPrev + m_nSamples;
+    double* re      = sinCur  + m_nSamples;
+    double* im      = re      + m_nSamples;
+    for(int i=0; i<m_nSamples; i++) {
+        double theta = PI * (m_z[i] - m_lb) / Lz;
+        twoCos[i] = 2.0 * cos(theta);
+        sinCur[i] = sin(theta);
+    }
+
+    for(size_t n = 0; n < coeffs.size(); n++) {
+        double a = coeffs[n].real();
+        double b = coeffs[n].imag();
         for(int i=0; i<m_nSamples; i++) {
-            complex<double> j(0.0, 1.0);
-            psiN[i] += cNn * exp(-j * shift * (n + 0.5)) * psi[i];
+            double sn = sinCur[i];
+            re[i] += a * sn;
+            im[i] += b * sn;
+            // sin((n+1)*theta) = 2*cos(theta)*sin(n*theta) - sin((n-1)*theta)
+            sinCur[i]  = twoCos[i] * sn - sinPrev[i];
+            sinPrev[i] = sn;
         }
     }
+
+    double An2 = 2.0 / Lz;
     for(int i=0; i<m_nSamples; i++) {
-        m_pdf[i] = real(conj(psiN[i]) * psiN[i]);
+        m_pdf[i] = An2 * (re[i] * re[i] + im[i] * im[i]);
     }
 }
 
-vector<double> PeakDistribution::eigenFunction(int n)
+bool PeakDistribution::transformSeries(const vector<complex<double> >& coeffs)
 {
-    double Lz = m_ub - m_lb;
-    double An = sqrt(2.0 / Lz);
+    if(!isEquallySpaced()) {
+        return false;
+    }
 
-    vector<double> psi(m_nSamples, 0.0);
+    // On the grid theta_i = pi*i/M, sin(n*theta_i) is 2M-periodic and odd in
+    // n, so basis functions beyond M fold back onto 1,...,M-1.
+    size_t M = m_nSamples - 1;
+    vector<complex<double> >& x = m_series;
+    x.assign(M, complex<double>(0.0, 0.0));
+    for(size_t n = 1; n <= coeffs.size(); n++) {
+        size_t r = n % (2 * M);
+        if(r == 0 || r == M) {
+            continue;
+        } else if(r < M) {
+            x[r] += coeffs[n-1];
+        } else {
+            x[2 * M - r] -= coeffs[n-1];
+        }
+    }
+
+    vector<complex<double> >& psi = m_psi;
+    Utils::sineTransform(x, psi);
+
+    double An2 = 2.0 / (m_ub - m_lb);
+    for(int i=0; i<m_nSamples; i++) {
+        m_pdf[i] = An2 * norm(psi[i]);
+    }
+    return true;
+}
+
+bool PeakDistribution::isEquallySpaced() const
+{
+    if(m_nSamples < 3) {
+        return false;
+    }
+    // generateEquallySpacedZ() sets the last point to the upper bound, so
+    // compare the interior spacing with the full range
+    double dz = (m_ub - m_lb) / (m_nSamples - 1);
+    return (fabs(m_z[1] - m_z[0] - dz) <= 1e-9 * dz) &&
+           (fabs(m_z[m_nSamples-1] - m_z[m_nSamples-2] - dz) <= 1e-9 * dz);
+}
+
+/// TRUNCATED NORMAL DISTRIBUTION
+TruncatedNormalDistribution::TruncatedNormalDistribution()
+    : m_mean(0.5),
+      m_sd(0.5 / 3.0)
+{
+    defineResolution(1.0 / (DistNSamples - 1));
+    updateStandardBounds();
+}
+
+TruncatedNormalDistribution::TruncatedNormalDistribution(double mean,
+                                                         double sd,
+                                                         double lb,
+                                                         double ub)
+    : m_mean(mean),
+      m_sd(1.0)
+{
+    defineBoundaries(lb, ub);
+    defineMeanAndSD(mean, sd);
+    // at least ten points per standard deviation, for narrow peaks
+    defineResolution(std::min((m_ub - m_lb) / (DistNSamples - 1),
+                              m_sd / 10.0));
+}
+
+TruncatedNormalDistribution::~TruncatedNormalDistribution()
+{
+
+}
+
+void TruncatedNormalDistribution::reset(double mean, double sd,
+                                        double lb, double ub)
+{
+    resetBase();
+    defineBoundaries(lb, ub);
+    defineMeanAndSD(mean, sd);
+    // at least ten points per standard deviation, for narrow peaks
+    defineResolution(std::min((m_ub - m_lb) / (DistNSamples - 1),
+                              m_sd / 10.0));
+}
+
+double TruncatedNormalDistribution::transformUniform(double u)
+{
+    return analyticQuantile(u);
+}
+
+void TruncatedNormalDistribution::sample(size_t n, double* out,
+                                         RandomStream& rs)
+{
+    rs.fill(out, n);
+    for(size_t i=0; i<n; i++) {
+        out[i] = analyticQuantile(out[i]);
+    }
+}
+
+void TruncatedNormalDistribution::defineBoundaries(double lb, double ub)
+{
+    IDistribution::defineBoundaries(lb, ub);
+    updateStandardBounds();
+}
+
+void TruncatedNormalDistribution::defineMeanAndSD(double mean, double sd)
+{
+    if(sd <= 0.0) {
+        sd = (m_ub - m_lb) * DistMinInterval;
+    }
+    m_mean = mean;
+    m_sd   = sd;
+    updateStandardBounds();
+    m_updated = false;
+}
+
+double TruncatedNormalDistribution::mean() const
+{
+    return m_mean;
+}
+
+double TruncatedNormalDistribution::sd() const
+{
+    return m_sd;
+}
+
+void TruncatedNormalDistribution::generateZ()
+{
+    generateEquallySpacedZ();
+}
+
+void TruncatedNormalDistribution::generatePDF()
+{
+    m_pdf.resize(m_nSamples);
+    if(m_mass > 0.0) {
+        double factor = 1.0 / (sqrt(2.0 * PI) * m_sd * m_mass);
+        for(int i=0; i<m_nSamples; i++) {
+            double x = (m_z[i] - m_mean) / m_sd;
+            m_pdf[i] = factor * exp(-x * x / 2.0);
+        }
+    } else {
+        // the exponential tail of the normal beyond the nearer bound
+        double r = (m_a >= 0.0) ? m_a : m_b;
+        double w = m_b - m_a;
+        for(int i=0; i<m_nSamples; i++) {
+            double t = (m_z[i] - m_lb) / m_sd;
+            m_pdf[i] = exponentialPDF(r, w, t) / m_sd;
+        }
+    }
+}
+
+bool TruncatedNormalDistribution::generateCDF()
+{
+    m_cdf.resize(m_nSamples);
+    double r = (m_a >= 0.0) ? m_a : m_b;
+    double w = m_b - m_a;
+    for(int i=0; i<m_nSamples; i++) {
+        double x = (m_z[i] - m_mean) / m_sd;
+        if(m_mass > 0.0) {
+            m_cdf[i] = Utils::normalMass(m_a, x) / m_mass;
+        } else {
+            m_cdf[i] = exponentialCDF(r, w, x - m_a);
+        }
+    }
+    m_cdf.front() = 0.0;
+    m_cdf.back()  = 1.0;
+    return true;
+}
+
+double TruncatedNormalDistribution::analyticQuantile(double u) const
+{
+    double x;
+    if(m_mass > 0.0) {
+        // the quantile is taken in the tail it falls in, where the normal
+        // cdf does not lose precision
+        double p = Utils::normalCDF(m_a) + u * m_mass;
+        if(p <= 0.5) {
+            x = Utils::normalQuantile(p);
+        } else {
+            x = -Utils::normalQuantile(Utils::normalCDF(-m_b)
+                                       + (1.0 - u) * m_mass);
+        }
+    } else {
+        // both bounds are so far in a tail that their probability
+        // underflows, and the normal is exponential there
+        double r = (m_a >= 0.0) ? m_a : m_b;
+        x = m_a + exponentialQuantile(r, m_b - m_a, u);
+    }
+    x = std::min(std::max(x, m_a), m_b);
+    return m_mean + m_sd * x;
+}
+
+void TruncatedNormalDistribution::updateStandardBounds()
+{
+    m_a    = (m_lb - m_mean) / m_sd;
+    m_b    = (m_ub - m_mean) / m_sd;
+    m_mass = Utils::normalMass(m_a, m_b);
+}
+
+/// BETA DISTRIBUTION
+BetaDistribution::BetaDistribution()
+{
+    defineShapes(2.0, 2.0);
+    defineResolution(1.0 / (DistNSamples - 1));
+}
+
+BetaDistribution::BetaDistribution(double alpha, double beta,
+                                   double lb, double ub)
+{
+    defineShapes(alpha, beta);
+    defineBoundaries(lb, ub);
+    defineResolution((m_ub - m_lb) / (DistNSamples - 1));
+}
+
+BetaDistribution::~BetaDistribution()
+{
+
+}
+
+void BetaDistribution::reset(double alpha, double beta, double lb, double ub)
+{
+    resetBase();
+    defineShapes(alpha, beta);
+    defineBoundaries(lb, ub);
+    defineResolution((m_ub - m_lb) / (DistNSamples - 1));
+}
+
+double BetaDistribution::sample(RandomStream& rs)
+{
+    return m_lb + (m_ub - m_lb) * chengSample(rs);
+}
+
+void BetaDistribution::sample(size_t n, double* out, RandomStream& rs)
+{
+    double range = m_ub - m_lb;
+    for(size_t i=0; i<n; i++) {
+        out[i] = m_lb + range * chengSample(rs);
+    }
+}
+
+double BetaDistribution::transformUniform(double u)
+{
+    return m_lb + (m_ub - m_lb)
+            * Utils::incompleteBetaInverse(m_alpha, m_beta, u);
+}
+
+double BetaDistribution::chengSample(RandomStream& rs) const
+{
+    // R. C. H. Cheng, Generating beta variates with nonintegral shape
+    // parameters, Communications of the ACM 21(4), 1978.
+    // a and b are the smaller and the larger shape.
+    const double a     = m_minShape;
+    const double b     = m_maxShape;
+    const double sum   = a + b;
+    const double log4  = 1.3862944;
+    const double maxV  = log(DBL_MAX);
+    const bool   alphaIsMin = (m_alpha == a);
+    double v, w;
+
+    if(a <= 1.0) {
+        // BC
+        for(;;) {
+            double u1 = rs.uniform();
+            double u2 = rs.uniform();
+            if(!(u1 > 0.0)) {
+                continue;
+            }
+            double z;
+            if(u1 < 0.5) {
+                double y = u1 * u2;
+                z = u1 * y;
+                if(0.25 * u2 + z - y >= m_rejK1) {
+                    continue;
+                }
+            } else {
+                z = u1 * u1 * u2;
+                if(z <= 0.25) {
+                    v = m_rejBeta * log(u1 / (1.0 - u1));
+                    w = (v <= maxV) ? b * exp(v) : DBL_MAX;
+                    break;
+                }
+                if(z >= m_rejK2) {
+                    continue;
+                }
+            }
+            v = m_rejBeta * log(u1 / (1.0 - u1));
+            w = (v <= maxV) ? b * exp(v) : DBL_MAX;
+            if(sum * (log(sum / (a + w)) + v) - log4 >= log(z)) {
+                break;
+            }
+        }
+        return alphaIsMin ? a / (a + w) : w / (a + w);
+    }
+
+    // BB
+    for(;;) {
+        double u1 = rs.uniform();
+        double u2 = rs.uniform();
+        if(!(u1 > 0.0)) {
+            continue;
+        }
+        v = m_rejBeta * log(u1 / (1.0 - u1));
+        w = (v <= maxV) ? a * exp(v) : DBL_MAX;
+        double z = u1 * u1 * u2;
+        double r = m_rejGamma * v - log4;
+        double s = a + r - w;
+        if(s + 2.609438 >= 5.0 * z) {
+            break;
+        }
+        double t = log(z);
+        if(s > t) {
+            break;
+        }
+        if(r + sum * log(sum / (b + w)) >= t) {
+            break;
+        }
+    }
+    return alphaIsMin ? w / (b + w) : b / (b + w);
+}
+
+void BetaDistribution::defineShapes(double alpha, double beta)
+{
+    m_alpha   = (alpha > 0.0) ? alpha : 1.0;
+    m_beta    = (beta  > 0.0) ? beta  : 1.0;
+    m_logBeta = Utils::logBeta(m_alpha, m_beta);
+
+    m_minShape = min(m_alpha, m_beta);
+    m_maxShape = max(m_alpha, m_beta);
+    double a = m_minShape;
+    double b = m_maxShape;
+    if(a <= 1.0) {
+        double delta = 1.0 + b - a;
+        m_rejBeta  = 1.0 / a;
+        m_rejGamma = 0.0;
+        m_rejK1    = delta * (0.0138889 + 0.0416667 * a)
+                / (b * m_rejBeta - 0.777778);
+        m_rejK2    = 0.25 + (0.5 + 0.25 / delta) * a;
+    } else {
+        m_rejBeta  = sqrt((a + b - 2.0) / (2.0 * a * b - a - b));
+        m_rejGamma = a + 1.0 / m_rejBeta;
+        m_rejK1    = 0.0;
+        m_rejK2    = 0.0;
+    }
+    m_updated = false;
+}
+
+double BetaDistribution::alpha() const
+{
+    return m_alpha;
+}
+
+double BetaDistribution::beta() const
+{
+    return m_beta;
+}
+
+void BetaDistribution::generateZ()
+{
+    generateEquallySpacedZ();
+}
+
+void BetaDistribution::generatePDF()
+{
+    m_pdf.resize(m_nSamples);
+    double range = m_ub - m_lb;
     for(int i=1; i<m_nSamples-1; i++) {
-        psi[i] = An * sin(PI * n * (m_z[i] - m_lb) / Lz);
+        double x = (m_z[i] - m_lb) / range;
+        m_pdf[i] = exp((m_alpha - 1.0) * log(x)
+                       + (m_beta - 1.0) * log1p(-x) - m_logBeta) / range;
+    }
+
+    // the bounds, where the density is zero, finite or infinite
+    int last = m_nSamples - 1;
+    if(m_alpha > 1.0) {
+        m_pdf[0] = 0.0;
+    } else if(m_alpha == 1.0) {
+        m_pdf[0] = exp(-m_logBeta) / range;
+    } else {
+        double x = (m_z[1] - m_lb) / range;
+        m_pdf[0] = Utils::incompleteBeta(m_alpha, m_beta, x)
+                / (m_z[1] - m_z[0]);
+    }
+    if(m_beta > 1.0) {
+        m_pdf[last] = 0.0;
+    } else if(m_beta == 1.0) {
+        m_pdf[last] = exp(-m_logBeta) / range;
+    } else {
+        double x = (m_z[last-1] - m_lb) / range;
+        m_pdf[last] = (1.0 - Utils::incompleteBeta(m_alpha, m_beta, x))
+                / (m_z[last] - m_z[last-1]);
+    }
+}
+
+bool BetaDistribution::generateCDF()
+{
+    m_cdf.resize(m_nSamples);
+    double range = m_ub - m_lb;
+    for(int i=0; i<m_nSamples; i++) {
+        double x = (m_z[i] - m_lb) / range;
+        m_cdf[i] = Utils::incompleteBeta(m_alpha, m_beta, x);
+    }
+    m_cdf.front() = 0.0;
+    m_cdf.back()  = 1.0;
+    return true;
+}
+
+/// TRUNCATED EXPONENTIAL DISTRIBUTION
+TruncatedExponentialDistribution::TruncatedExponentialDistribution()
+    : m_rate(1.0)
+{
+    defineResolution(1.0 / (DistNSamples - 1));
+}
+
+TruncatedExponentialDistribution::TruncatedExponentialDistribution(
+        double rate, double lb, double ub)
+    : m_rate(rate)
+{
+    defineBoundaries(lb, ub);
+    defineResolution((m_ub - m_lb) / (DistNSamples - 1));
+}
+
+TruncatedExponentialDistribution::~TruncatedExponentialDistribution()
+{
+
+}
+
+void TruncatedExponentialDistribution::reset(double rate, double lb, double ub)
+{
+    resetBase();
+    m_rate = rate;
+    defineBoundaries(lb, ub);
+    defineResolution((m_ub - m_lb) / (DistNSamples - 1));
+}
+
+double TruncatedExponentialDistribution::transformUniform(double u)
+{
+    return m_lb + exponentialQuantile(m_rate, m_ub - m_lb, u);
+}
+
+void TruncatedExponentialDistribution::sample(size_t n, double* out,
+                                              RandomStream& rs)
+{
+    rs.fill(out, n);
+    double w = m_ub - m_lb;
+    for(size_t i=0; i<n; i++) {
+        out[i] = m_lb + exponentialQuantile(m_rate, w, out[i]);
+    }
+}
+
+void TruncatedExponentialDistribution::defineRate(double rate)
+{
+    if(m_rate != rate) {
+        m_updated = false;
     }
-    return psi;
+    m_rate = rate;
 }
 
+double TruncatedExponentialDistribution::rate() const
+{
+    return m_rate;
+}
+
+void TruncatedExponentialDistribution::generateZ()
+{
+    generateEquallySpacedZ();
+}
+
+void TruncatedExponentialDistribution::generatePDF()
+{
+    m_pdf.resize(m_nSamples);
+    double w = m_ub - m_lb;
+    for(int i=0; i<m_nSamples; i++) {
+        m_pdf[i] = exponentialPDF(m_rate, w, m_z[i] - m_lb);
+    }
+}
+
+bool TruncatedExponentialDistribution::generateCDF()
+{
+    m_cdf.resize(m_nSamples);
+    double w = m_ub - m_lb;
+    for(int i=0; i<m_nSamples; i++) {
+        m_cdf[i] = exponentialCDF(m_rate, w, m_z[i] - m_lb);
+    }
+    m_cdf.front() = 0.0;
+    m_cdf.back()  = 1.0;
+    return true;
+}
 
 /// MERGED DISTRIBUTION
 MergedDistribution::MergedDistribution()
+    : m_samplingMode(MixtureSampling)
 {
 
 }
 
 MergedDistribution::~MergedDistribution()
 {
-    for(int i = 0; i < m_distributions.size(); i++) {
+    for(size_t i = 0; i < m_distributions.size(); i++) {
         delete m_distributions[i];
     }
 }
 
-void MergedDistribution::generateZ()
+double MergedDistribution::transformUniform(double u)
 {
-    int nDistributions = (int)m_distributions.size();
+    if((m_samplingMode == TabulatedSampling) || m_distributions.empty()) {
+        return IDistribution::transformUniform(u);
+    }
 
-    if(nDistributions == 0) {
+    // The same uniform value picks the component and, rescaled to the
+    // component's share of [0,1], samples it
+    size_t last = m_distributions.size() - 1;
+    size_t i = upper_bound(m_cumulativeRatios.begin(),
+                           m_cumulativeRatios.begin() + last, u)
+            - m_cumulativeRatios.begin();
+    double lower = (i == 0) ? 0.0 : m_cumulativeRatios[i-1];
+    double share = m_cumulativeRatios[i] - lower;
+    double v = (share > 0.0) ? (u - lower) / share : 0.0;
+    return m_distributions[i]->transformUniform(min(max(v, 0.0), 1.0));
+}
+
+void MergedDistribution::sample(size_t n, double* out, RandomStream& rs)
+{
+    if((m_samplingMode == TabulatedSampling) || m_distributions.empty()) {
+        IDistribution::sample(n, out, rs);
         return;
     }
 
-    for(int i=0; i<nDistributions; i++) {
-        addZSamplesOfOneDistribution(m_distributions[i]);
+    rs.fill(out, n);
+    for(size_t i=0; i<n; i++) {
+        out[i] = transformUniform(out[i]);
     }
 }
 
-void MergedDistribution::addZSamplesOfOneDistribution(IDistribution* d)
+void MergedDistribution::generateZ()
 {
-    vector<double> newZ = d->zSamples();
-    if(newZ.empty())  {
+    size_t nDistributions = m_distributions.size();
+
+    if(nDistributions == 0) {
         return;
     }
-    vector<double>::iterator iNew = newZ.begin();
-    vector<double>::iterator iExist = m_z.begin();
-    // merge newZ and m_z into augZ
-    vector<double> augZ;
-
-//    int iNew = 0; // iterator for newZ
-//    int iAug = 0; // iterator for m_z
 
-    while((iNew != newZ.end()) && (iExist != m_z.end())) {
-        if(*iNew == *iExist) {
-            augZ.push_back(*iExist++);
-            iNew++;
-        }
-        else if(*iNew < *iExist) {
-            augZ.push_back(*iNew++);
-        }
-        else {
-            augZ.push_back(*iExist++);
+    // merge the component grids in one pass, dropping repeated values
+    typedef pair<double, size_t> Head; // the next value of a component grid
+    priority_queue<Head, vector<Head>, greater<Head> > heads;
+    vector<const vector<double>*> grids(nDistributions);
+    vector<size_t> next(nDistributions, 0);
+    size_t total = 0;
+    for(size_t i=0; i<nDistributions; i++) {
+        grids[i] = &m_distributions[i]->zSamples();
+        total += grids[i]->size();
+        if(!grids[i]->empty()) {
+            heads.push(Head(grids[i]->front(), i));
         }
     }
 
-    while(iNew != newZ.end()) {
-        augZ.push_back(*iNew++);
+    m_z.reserve(total);
+    while(!heads.empty()) {
+        Head head = heads.top();
+        heads.pop();
+        if(m_z.empty() || (head.first != m_z.back())) {
+            m_z.push_back(head.first);
+        }
+        size_t i = head.second;
+        if(++next[i] < grids[i]->size()) {
+            heads.push(Head((*grids[i])[next[i]], i));
+        }
     }
 
-    while(iExist != m_z.end()) {
-        augZ.push_back(*iExist++);
+    if(m_z.empty()) {
+        return;
     }
-
-    m_z.swap(augZ);
     m_lb = m_z.front();
     m_ub = m_z.back();
     m_nSamples = (int)m_z.size();
-    augZ.clear();
 }
 
 void MergedDistribution::generatePDF()
@@ -474,7 +1467,7 @@ void MergedDistribution::generatePDF()
 
     m_pdf.resize(m_nSamples);
 
-    for(int i=0; i<nDistributions; i++) {
+    for(size_t i=0; i<nDistributions; i++) {
         addOnePDF(m_distributions[i], m_ratios[i]);
     }
 }
@@ -482,33 +1475,30 @@ void MergedDistribution::generatePDF()
 void MergedDistribution::addOnePDF(IDistribution* d, double ratio)
 {
     // call this function only after the samples are integrated into m_z
-    vector<double> newPDF = d->pdf();
+    const vector<double>& newPDF = d->pdf();
     if(newPDF.empty()) {
         return;
     }
-    vector<double> newZ   = d->zSamples();
+    const vector<double>& newZ = d->zSamples();
 
     // find the range of the new pdf
-    vector<double>::iterator first = m_z.begin();
-    vector<double>::iterator last  = m_z.end();
-    vector<double>::iterator pdfIter  = m_pdf.begin();
-
-    while(newZ.front() > *first) {
-        ++first;
-        ++pdfIter;
-    }
-    while(newZ.back() < *(last - 1)) {
-        --last;
+    vector<double>::iterator first = lower_bound(m_z.begin(), m_z.end(),
+                                                 newZ.front());
+    vector<double>::iterator last  = upper_bound(first, m_z.end(),
+                                                 newZ.back());
+    if(first == last) {
+        return;
     }
+    vector<double>::iterator pdfIter = m_pdf.begin() + (first - m_z.begin());
 
-    //Interpolate the new pdf over the new samples in its range
-    LinearInterpolator pdfInterpolator(newZ, newPDF);
-    vector<double> tmp = pdfInterpolator.interpolateV(vector<double>(first, last));
-    newPDF.swap(tmp);
+    //Interpolate the new pdf over the new samples in its range, which are
+    //sorted, reading the component tables in place
+    vector<double> rangePDF(last - first);
+    interpolateSorted(newZ, newPDF, rangePDF.size(), &*first, rangePDF.data());
 
     // add the new pdf times its weight to the existing pdf
     vector<double>::iterator newIter;
-    for(newIter = newPDF.begin(); newIter == newPDF.end(); ++newIter, ++pdfIter) {
+    for(newIter = rangePDF.begin(); newIter != rangePDF.end(); ++newIter, ++pdfIter) {
         *pdfIter += (*newIter * ratio);
     }
 }
@@ -520,9 +1510,47 @@ void MergedDistribution::appendDistribution(IDistribution* d)
 
 void MergedDistribution::appendDistribution(IDistribution* d, double ratio)
 {
+    if(m_distributions.empty()) {
+        m_lb = d->lowerBound();
+        m_ub = d->upperBound();
+    } else {
+        m_lb = min(m_lb, d->lowerBound());
+        m_ub = max(m_ub, d->upperBound());
+    }
     m_distributions.push_back(d);
     m_ratios.push_back(max(ratio, 0.0));
-    computeDistribution();
+
+    double total = 0.0;
+    for(size_t i=0; i<m_ratios.size(); i++) {
+        total += m_ratios[i];
+    }
+    m_cumulativeRatios.resize(m_ratios.size());
+    double cumulative = 0.0;
+    for(size_t i=0; i<m_ratios.size(); i++) {
+        cumulative += m_ratios[i];
+        m_cumulativeRatios[i] = (total > 0.0) ? cumulative / total
+                                              : (i + 1.0) / m_ratios.size();
+    }
+
+    // the union grid is built when the tables are needed
+    m_updated = false;
+}
+
+void MergedDistribution::finalize()
+{
+    if(!m_updated) {
+        computeDistribution();
+    }
+}
+
+void MergedDistribution::defineSamplingMode(SamplingMode mode)
+{
+    m_samplingMode = mode;
+}
+
+MergedDistribution::SamplingMode MergedDistribution::samplingMode() const
+{
+    return m_samplingMode;
 }
 
 } // namespace CODeM
@@ -27,14 +27,16 @@
 #define DISTRIBUTIONS_H
 
 #include <core/CODeMGlobal.h>
+#include <core/DistributionTable.h>
 
 #include <vector>
+#include <complex>
+#include <memory>
+#include <cstddef>
 
 namespace CODeM {
 
-namespace Utils {
-class LinearInterpolator;
-}
+struct DistributionKey;
 
 class IDistribution
 {
@@ -42,36 +44,93 @@ public:
     IDistribution();
     virtual ~IDistribution();
 
-    virtual double      sample();
-    std::vector<double> zSamples();
-    std::vector<double> pdf();
-    std::vector<double> cdf();
+    // sample() draws from the global stream, sample(rs) from the given one
+    double              sample();
+    virtual double      sample(Utils::RandomStream& rs);
+    // n samples from consecutive values of the stream, the same as n calls
+    // to sample(rs)
+    virtual void        sample(std::size_t n, double* out,
+                               Utils::RandomStream& rs);
+    // The tables, computed if needed. The references are valid until the
+    // distribution is changed.
+    const std::vector<double>& zSamples();
+    const std::vector<double>& pdf();
+    const std::vector<double>& cdf();
+    // The computed tables. They stay valid and unchanged when the
+    // distribution changes, and can be sampled from several threads.
+    std::shared_ptr<const DistributionTable> table();
+    // The value below which the probability is u, from the tabulated cdf
+    double              inverseCDF(double u);
+    // The sample for the uniform value u. Unless a distribution samples by
+    // rejection, every sample() is one uniform value passed through this
+    // map, which defaults to inverseCDF().
+    virtual double      transformUniform(double u);
 
     virtual void        defineBoundaries(double lb, double ub);
+    // Widens an empty or inverted range the way defineBoundaries() does
+    static void         correctBoundaries(double& lb, double& ub);
     void                defineResolution(double            dz);
     double              resolution()                     const;
     double              lowerBound()                     const;
     double              upperBound()                     const;
 
+    // A positive tolerance replaces the equally spaced grid with an adaptive
+    // one: the grid is refined at least DistAdaptiveRefinement times, and
+    // then only the points needed to interpolate the pdf and the cdf
+    // linearly to within the tolerance, relative to their maxima, are kept.
+    void                defineAdaptiveTolerance(double tol);
+    double              adaptiveTolerance()              const;
+    // The number of points in the current tables
+    int                 nSamples();
+
+    // The tolerance of new distributions
+    static void         defineDefaultAdaptiveTolerance(double tol);
+    static double       defaultAdaptiveTolerance();
+    // The points in all the tables built so far, and in the equally spaced
+    // grids they replace
+    static unsigned long long gridPoints();
+    static unsigned long long uniformGridPoints();
+
 protected:
     void                computeDistribution();
+    // Called before every build. Distributions that can share their tables
+    // through the DistributionCache build them from their parameters
+    // snapped to the cache grid, and return true with the key of the
+    // resulting table.
+    virtual bool        quantiseForCache(DistributionKey& key);
     virtual void        generateZ() = 0;
     virtual void        generatePDF() = 0;
+    // Distributions with an analytic cdf fill m_cdf over m_z and return
+    // true. The others return false, and their cdf is integrated from the pdf.
+    virtual bool        generateCDF();
     void                generateEquallySpacedZ();
-
+    // Back to the state of a new distribution, keeping the buffers
+    void                resetBase();
+    // The inverse of the tabulated cdf, for one value or in place for a block
+    double              quantile(double u)                  const;
+    void                quantiles(std::size_t n, double* u) const;
+
+    // generateZ(), generatePDF() and generateCDF() fill m_z, m_pdf and
+    // m_cdf, which are moved into the table once it is built
     double              m_lb;
     double              m_ub;
     std::vector<double> m_z;
     std::vector<double> m_pdf;
+    std::vector<double> m_cdf;
     int                 m_nSamples;
     bool                m_updated;
 
 private:
     void                calculateCDF();
+    void                coarsenGrid();
 
-    double                      m_dz;
-    Utils::LinearInterpolator*  m_quantileInterpolator;
-    std::vector<double>         m_cdf;
+    double              m_dz;
+    double              m_adaptiveTol;
+    int                 m_nUniformSamples;
+    std::shared_ptr<const DistributionTable> m_table;
+    // The last table built here. When nothing else shares it, the next build
+    // reuses it and its buffers.
+    std::shared_ptr<DistributionTable>       m_ownTable;
 
 };
 
@@ -83,7 +142,12 @@ public:
     UniformDistribution(double lb, double ub);
     virtual ~UniformDistribution();
 
-    double sample();
+    // The same as a new UniformDistribution(lb, ub)
+    void   reset(double lb, double ub);
+
+    using IDistribution::sample;
+    double transformUniform(double u);
+    void   sample(std::size_t n, double* out, Utils::RandomStream& rs);
 
     void  generateZ();
     void  generatePDF();
@@ -97,7 +161,12 @@ public:
     LinearDistribution(double lb, double ub, bool ascend = true);
     virtual ~LinearDistribution();
 
-    double sample();
+    // The same as a new LinearDistribution(lb, ub, ascend)
+    void   reset(double lb, double ub, bool ascend = true);
+
+    using IDistribution::sample;
+    double transformUniform(double u);
+    void   sample(std::size_t n, double* out, Utils::RandomStream& rs);
     void   generateZ();
     void   generatePDF();
 
@@ -112,43 +181,223 @@ private:
 class PeakDistribution : public IDistribution
 {
 public:
+    // How the wavefunction series is evaluated over the grid
+    enum SeriesEvaluation {
+        AutoSeries,      // the cheaper of the two, estimated per build
+        DirectSeries,    // every basis function at every grid point
+        TransformSeries  // a discrete sine transform of the coefficients
+    };
+
     PeakDistribution();
     PeakDistribution(double tendency, double locality);
     virtual ~PeakDistribution();
 
+    // The same as a new PeakDistribution(tendency, locality)
+    void   reset(double tendency, double locality);
+
+    // With a loaded PeakQuantileSurface the samples are interpolated from
+    // the surface, and the tables are only computed for pdf() and cdf()
+    using IDistribution::sample;
+    double transformUniform(double u);
+    void   sample(std::size_t n, double* out, Utils::RandomStream& rs);
+
     void  defineTendencyAndLocality(double tendency, double locality);
     double tendency()  const;
     double locality()  const;
 
+    void             defineSeriesEvaluation(SeriesEvaluation method);
+    SeriesEvaluation seriesEvaluation() const;
+
+    void generateZ();
+    void generatePDF();
+
+protected:
+    bool quantiseForCache(DistributionKey& key);
+
+private:
+    // cNn*exp(-j*shift*n) for n = 1,...,coeffs.size()
+    void seriesCoefficients(std::vector<std::complex<double> >& coeffs) const;
+    void directSeries(const std::vector<std::complex<double> >& coeffs);
+    bool transformSeries(const std::vector<std::complex<double> >& coeffs);
+    bool isEquallySpaced() const;
+
+    double           m_tendency;
+    double           m_locality;
+    // the parameters the tables are built from
+    double           m_genTendency;
+    double           m_genLocality;
+    SeriesEvaluation m_seriesEvaluation;
+    // work buffers, kept between builds
+    std::vector<std::complex<double> > m_coeffs;
+    std::vector<std::complex<double> > m_series;
+    std::vector<std::complex<double> > m_psi;
+    std::vector<double>                m_work;
+};
+
+
+/*  The analytic distributions tabulate their exact pdf and cdf. The
+ *  truncated normal and exponential distributions sample their exact
+ *  quantile function, from a single uniform value per sample, and use the
+ *  tables only for pdf() and cdf(). */
+
+// A normal distribution with the given mean and standard deviation,
+// truncated to [lb,ub]
+class TruncatedNormalDistribution : public IDistribution
+{
+public:
+    TruncatedNormalDistribution();
+    TruncatedNormalDistribution(double mean, double sd, double lb, double ub);
+    virtual ~TruncatedNormalDistribution();
+
+    // The same as a new TruncatedNormalDistribution(mean, sd, lb, ub)
+    void   reset(double mean, double sd, double lb, double ub);
+
+    using IDistribution::sample;
+    double transformUniform(double u);
+    void   sample(std::size_t n, double* out, Utils::RandomStream& rs);
+
+    void   defineBoundaries(double lb, double ub);
+    void   defineMeanAndSD(double mean, double sd);
+    double mean() const;
+    double sd()   const;
+
     void generateZ();
     void generatePDF();
+    bool generateCDF();
 
 private:
-    double m_tendency;
-    double m_locality;
+    double analyticQuantile(double u) const;
+    void   updateStandardBounds();
+
+    double m_mean;
+    double m_sd;
+    // the bounds in standard deviations from the mean, and the normal
+    // probability between them
+    double m_a;
+    double m_b;
+    double m_mass;
+};
+
+
+// A beta distribution with the shapes alpha and beta, scaled to [lb,ub].
+// Its quantile function has no closed form, so the stream is sampled by
+// Cheng's rejection algorithms, BB when both shapes are above 1 and BC
+// otherwise. A sample takes two or more uniforms from the stream.
+class BetaDistribution : public IDistribution
+{
+public:
+    BetaDistribution();
+    BetaDistribution(double alpha, double beta,
+                     double lb = 0.0, double ub = 1.0);
+    virtual ~BetaDistribution();
+
+    // The same as a new BetaDistribution(alpha, beta, lb, ub)
+    void   reset(double alpha, double beta, double lb = 0.0, double ub = 1.0);
+
+    using IDistribution::sample;
+    double sample(Utils::RandomStream& rs);
+    void   sample(std::size_t n, double* out, Utils::RandomStream& rs);
+    // The exact quantile, solved for u. It is much slower than sampling
+    // the stream, and is used where one uniform must give the sample, as
+    // in a mixture.
+    double transformUniform(double u);
+
+    // Shapes that are not positive are replaced by 1
+    void   defineShapes(double alpha, double beta);
+    double alpha() const;
+    double beta()  const;
+
+    // A pdf that is infinite at a bound is tabulated there as its mean over
+    // the first interval
+    void generateZ();
+    void generatePDF();
+    bool generateCDF();
+
+private:
+    // A sample of the standard beta distribution, in [0,1]
+    double chengSample(Utils::RandomStream& rs) const;
+
+    double m_alpha;
+    double m_beta;
+    double m_logBeta;
+    // The constants of the rejection algorithm, for the smaller and the
+    // larger shape
+    double m_minShape;
+    double m_maxShape;
+    double m_rejBeta;
+    double m_rejGamma;
+    double m_rejK1;
+    double m_rejK2;
+};
+
+
+// A distribution with the pdf proportional to exp(-rate*(z-lb)) over
+// [lb,ub]. A negative rate makes it increase towards ub, and a zero rate
+// makes it uniform.
+class TruncatedExponentialDistribution : public IDistribution
+{
+public:
+    TruncatedExponentialDistribution();
+    TruncatedExponentialDistribution(double rate, double lb, double ub);
+    virtual ~TruncatedExponentialDistribution();
+
+    // The same as a new TruncatedExponentialDistribution(rate, lb, ub)
+    void   reset(double rate, double lb, double ub);
+
+    using IDistribution::sample;
+    double transformUniform(double u);
+    void   sample(std::size_t n, double* out, Utils::RandomStream& rs);
+
+    void   defineRate(double rate);
+    double rate() const;
+
+    void generateZ();
+    void generatePDF();
+    bool generateCDF();
 
-    std::vector<double> eigenFunction(int n);
+private:
+    double m_rate;
 };
 
 
 class MergedDistribution : public IDistribution
 {
 public:
+    // How the samples are drawn
+    enum SamplingMode {
+        MixtureSampling,   // pick a component by its ratio, then sample it
+        TabulatedSampling  // invert the cdf tabulated on the union grid
+    };
+
     MergedDistribution();
     MergedDistribution(const MergedDistribution& dist);
     virtual ~MergedDistribution();
 
+    // In mixture sampling the union grid is only built for pdf() and cdf()
+    using IDistribution::sample;
+    double transformUniform(double u);
+    void   sample(std::size_t n, double* out, Utils::RandomStream& rs);
+
     void generateZ();
     void generatePDF();
 
+    // Appending only collects the components and their ratios. The union
+    // grid and the tables are built once, by finalize() or when they are
+    // first needed.
     void appendDistribution(IDistribution* d);
     void appendDistribution(IDistribution* d, double ratio);
+    void finalize();
+
+    void         defineSamplingMode(SamplingMode mode);
+    SamplingMode samplingMode() const;
 
 private:
     std::vector<IDistribution*> m_distributions;
     std::vector<double>                m_ratios;
+    // the normalised ratios, accumulated
+    std::vector<double>         m_cumulativeRatios;
+    SamplingMode                m_samplingMode;
 
-    void addZSamplesOfOneDistribution(IDistribution* d);
     void addOnePDF(IDistribution* d,       double ratio);
 };
 
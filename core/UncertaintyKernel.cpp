@@ -32,6 +32,40 @@ using namespace CODeM::Utils;
 
 namespace CODeM {
 
+namespace {
+
+// The conditions under which the kernels take the given bounds instead of
+// the default [0,1] ones
+bool acceptIdealAndAntiIdeal(const vector<double> &ideal,
+                             const vector<double> &antiIdeal)
+{
+    if(ideal.size() != antiIdeal.size()) {
+        return false;
+    }
+    for(int i=0; i<ideal.size(); i++) {
+        if(antiIdeal[i] <= ideal[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool acceptInputsBounds(const vector<double> &lowerBounds,
+                        const vector<double> &upperBounds)
+{
+    if(lowerBounds.size() != upperBounds.size()) {
+        return false;
+    }
+    for(int i=0; i<lowerBounds.size(); i++) {
+        if(upperBounds[i] <= lowerBounds[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
 //UncertaintyKernel::UncertaintyKernel(const vector<double> &inputs,
 //                                     const vector<double> &outputs)
 //    : m_inputs(inputs),
@@ -173,12 +207,7 @@ void UncertaintyKernel::defineDirectedObjectiveBoundaries()
 void UncertaintyKernel::defineIdealAndAntiIdeal(const vector<double> &ideal,
                                                 const vector<double> &antiIdeal)
 {
-    if(ideal.size() == antiIdeal.size()) {
-        for(int i=0; i<ideal.size(); i++) {
-            if(antiIdeal[i] <= ideal[i]) {
-                return;
-            }
-        }
+    if(acceptIdealAndAntiIdeal(ideal, antiIdeal)) {
         m_ideal     = ideal;
         m_antiIdeal = antiIdeal;
     }
@@ -187,15 +216,188 @@ void UncertaintyKernel::defineIdealAndAntiIdeal(const vector<double> &ideal,
 void UncertaintyKernel::defineInputsBounds(const vector<double> &lowerBounds,
                                            const vector<double> &upperBounds)
 {
-    if(lowerBounds.size() == upperBounds.size()) {
-        for(int i=0; i<lowerBounds.size(); i++) {
-            if(lowerBounds[i] <= upperBounds[i]) {
-                return;
-            }
-        }
+    if(acceptInputsBounds(lowerBounds, upperBounds)) {
         m_inLowerBounds = lowerBounds;
         m_inUpperBounds = upperBounds;
     }
 }
 
+/// UNCERTAINTY KERNEL BATCH
+UncertaintyKernelBatch::UncertaintyKernelBatch(const double* outputs,
+                                               int nSols,
+                                               int nObj,
+                                               double lb,
+                                               double ub,
+                                               const vector<double> &ideal,
+                                               const vector<double> &antiIdeal)
+    : m_nSols(nSols > 0 ? nSols : 0),
+      m_nObj(nObj > 0 ? nObj : 0),
+      m_nVars(0)
+{
+    vector<double> lbs(m_nSols, lb);
+    vector<double> ubs(m_nSols, ub);
+    calcObjectiveProperties(outputs, lbs.data(), ubs.data(), ideal, antiIdeal);
+}
+
+UncertaintyKernelBatch::UncertaintyKernelBatch(const double* outputs,
+                                               int nSols,
+                                               int nObj,
+                                               const double* lb,
+                                               const double* ub,
+                                               const vector<double> &ideal,
+                                               const vector<double> &antiIdeal)
+    : m_nSols(nSols > 0 ? nSols : 0),
+      m_nObj(nObj > 0 ? nObj : 0),
+      m_nVars(0)
+{
+    calcObjectiveProperties(outputs, lb, ub, ideal, antiIdeal);
+}
+
+UncertaintyKernelBatch::UncertaintyKernelBatch(const double* inputs,
+                                               int nVars,
+                                               const double* outputs,
+                                               int nSols,
+                                               int nObj,
+                                               double lb,
+                                               double ub,
+                                               const vector<double> &inputsLowerBounds,
+                                               const vector<double> &inputsUpperBounds,
+                                               const vector<double> &ideal,
+                                               const vector<double> &antiIdeal)
+    : m_nSols(nSols > 0 ? nSols : 0),
+      m_nObj(nObj > 0 ? nObj : 0),
+      m_nVars(nVars > 0 ? nVars : 0)
+{
+    vector<double> lbs(m_nSols, lb);
+    vector<double> ubs(m_nSols, ub);
+    calcObjectiveProperties(outputs, lbs.data(), ubs.data(), ideal, antiIdeal);
+    calcDecisionComponents(inputs, inputsLowerBounds, inputsUpperBounds);
+}
+
+UncertaintyKernelBatch::~UncertaintyKernelBatch()
+{
+
+}
+
+int UncertaintyKernelBatch::nSolutions() const
+{
+    return m_nSols;
+}
+
+const vector<double>& UncertaintyKernelBatch::proximity() const
+{
+    return m_proximity;
+}
+
+const vector<double>& UncertaintyKernelBatch::symmetry() const
+{
+    return m_symmetry;
+}
+
+const double* UncertaintyKernelBatch::oComponent(int idx) const
+{
+    if((idx < 0) || (idx >= m_nObj)) {
+        return 0;
+    }
+    return m_oComponents.data() + (size_t)idx * m_nSols;
+}
+
+const double* UncertaintyKernelBatch::dComponent(int idx) const
+{
+    if((idx < 0) || (idx >= m_nVars)) {
+        return 0;
+    }
+    return m_dComponents.data() + (size_t)idx * m_nSols;
+}
+
+void UncertaintyKernelBatch::calcObjectiveProperties(const double* outputs,
+                                                     const double* lb,
+                                                     const double* ub,
+                                                     const vector<double> &ideal,
+                                                     const vector<double> &antiIdeal)
+{
+    int nSols = m_nSols;
+    int nObj  = m_nObj;
+    vector<double> lBounds(nObj, 0.0);
+    vector<double> uBounds(nObj, 1.0);
+    if((ideal.size() == (size_t)nObj)
+            && acceptIdealAndAntiIdeal(ideal, antiIdeal)) {
+        lBounds = ideal;
+        uBounds = antiIdeal;
+    }
+
+    // the components, a column per objective
+    m_oComponents.resize((size_t)nObj * nSols);
+    for(int j=0; j<nObj; j++) {
+        double  lo    = lBounds[j];
+        double  range = uBounds[j] - lBounds[j];
+        double* col   = m_oComponents.data() + (size_t)j * nSols;
+        for(int i=0; i<nSols; i++) {
+            col[i] = (outputs[(size_t)i * nObj + j] - lo) / range;
+        }
+    }
+
+    m_proximity.assign(nSols, 0.0);
+    m_symmetry.assign(nSols, 0.0);
+    if(nObj < 2) {
+        return;
+    }
+
+    // The normalised vectors, with their 2-norm distance and their 1-norm
+    // for the projection on the k-1 simplex. The symmetry is the 2-norm of
+    // the projection.
+    vector<double> normalised(outputs, outputs + (size_t)nSols * nObj);
+    normaliseToUnitBox(normalised.data(), nSols, nObj, lBounds.data(),
+                       uBounds.data());
+
+    double symRange  = 1.0 - 1.0/sqrt((double)nObj);
+    for(int i=0; i<nSols; i++) {
+        const double* x = normalised.data() + (size_t)i * nObj;
+        double dist = normP<TwoNorm>(x, nObj, 2.0);
+        double inv1 = 1.0 / normP<OneNorm>(x, nObj, 1.0);
+        double sumSq = 0.0;
+        for(int j=0; j<nObj; j++) {
+            double d = x[j] * inv1;
+            sumSq += d * d;
+        }
+
+        // boundaries that are not increasing are replaced by [0,1]
+        bool   valid = ub[i] > lb[i];
+        double dirLB = valid ? lb[i] : 0.0;
+        double dirUB = valid ? ub[i] : 1.0;
+        double prox  = (dist - dirLB) / (dirUB - dirLB);
+        prox = (dist >= dirUB) ? 1.0 : prox;
+        prox = (dist <= dirLB) ? 0.0 : prox;
+        m_proximity[i] = prox;
+
+        double sym = (1.0 - sqrt(sumSq)) / symRange;
+        m_symmetry[i] = sym * sym;
+    }
+}
+
+void UncertaintyKernelBatch::calcDecisionComponents(const double* inputs,
+                                                    const vector<double> &lowerBounds,
+                                                    const vector<double> &upperBounds)
+{
+    int nSols = m_nSols;
+    int nVars = m_nVars;
+    vector<double> lBounds(nVars, 0.0);
+    vector<double> uBounds(nVars, 1.0);
+    if((lowerBounds.size() == (size_t)nVars)
+            && acceptInputsBounds(lowerBounds, upperBounds)) {
+        lBounds = lowerBounds;
+        uBounds = upperBounds;
+    }
+
+    m_dComponents.resize((size_t)nVars * nSols);
+    for(int j=0; j<nVars; j++) {
+        double  lo    = lBounds[j];
+        double  range = uBounds[j] - lBounds[j];
+        double* col   = m_dComponents.data() + (size_t)j * nSols;
+        for(int i=0; i<nSols; i++) {
+            col[i] = (inputs[(size_t)i * nVars + j] - lo) / range;
+        }
+    }
+}
+
 } // namespace CODeM
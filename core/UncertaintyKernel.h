@@ -88,6 +88,74 @@ private:
     void calcDirectionAndDistance();
 };
 
+/*  The UncertaintyKernel properties of a whole population. The objective
+ *  and decision vectors are the rows of row-major blocks, and every
+ *  property is computed for all the solutions in a few passes, into a
+ *  column with one value per solution. The bounds are accepted or ignored
+ *  as UncertaintyKernel does, and the values are the same as those of an
+ *  UncertaintyKernel per solution. */
+class UncertaintyKernelBatch
+{
+public:
+    UncertaintyKernelBatch(const double* outputs,
+                           int nSols,
+                           int nObj,
+                           double lb,
+                           double ub,
+                           const vector<double> &ideal,
+                           const vector<double> &antiIdeal);
+    // With the directed objective boundaries lb[i] and ub[i] of solution i
+    UncertaintyKernelBatch(const double* outputs,
+                           int nSols,
+                           int nObj,
+                           const double* lb,
+                           const double* ub,
+                           const vector<double> &ideal,
+                           const vector<double> &antiIdeal);
+    UncertaintyKernelBatch(const double* inputs,
+                           int nVars,
+                           const double* outputs,
+                           int nSols,
+                           int nObj,
+                           double lb,
+                           double ub,
+                           const vector<double> &inputsLowerBounds,
+                           const vector<double> &inputsUpperBounds,
+                           const vector<double> &ideal,
+                           const vector<double> &antiIdeal);
+    ~UncertaintyKernelBatch();
+
+    int nSolutions() const;
+
+    // One value per solution. Without at least two objectives the values
+    // are 0.
+    const vector<double>& proximity() const;
+    const vector<double>& symmetry()  const;
+    // The nSolutions() components of objective or decision variable idx,
+    // or 0 for an invalid idx
+    const double* oComponent(int idx) const;
+    const double* dComponent(int idx) const;
+
+private:
+    void calcObjectiveProperties(const double* outputs,
+                                 const double* lb, const double* ub,
+                                 const vector<double> &ideal,
+                                 const vector<double> &antiIdeal);
+    void calcDecisionComponents(const double* inputs,
+                                const vector<double> &lowerBounds,
+                                const vector<double> &upperBounds);
+
+    int                 m_nSols;
+    int                 m_nObj;
+    int                 m_nVars;
+    vector<double>      m_proximity;
+    vector<double>      m_symmetry;
+    // column-major: the components of one objective or variable are
+    // contiguous
+    vector<double>      m_oComponents;
+    vector<double>      m_dComponents;
+};
+
 } // namespace CODeM
 
 #endif // UNCERTAINTYKERNEL_H
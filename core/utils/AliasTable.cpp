@@ -0,0 +1,127 @@
+/****************************************************************************
+**
+** The MIT License (MIT)
+**
+** Copyright (c) 2016 The University of Sheffield (www.sheffield.ac.uk)
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in all
+** copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE
+**
+****************************************************************************/
+#include <core/utils/AliasTable.h>
+#include <math.h>
+
+using std::vector;
+
+namespace CODeM {
+namespace Utils {
+
+AliasTable::AliasTable()
+{
+
+}
+
+bool AliasTable::define(const vector<double>& weights)
+{
+    m_threshold.clear();
+    m_alias.clear();
+
+    int    n     = (int)weights.size();
+    double total = 0.0;
+    for(int i = 0; i < n; i++) {
+        if(!(weights[i] >= 0.0) || !isfinite(weights[i])) {
+            return false;
+        }
+        total += weights[i];
+    }
+    if(!(total > 0.0)) {
+        return false;
+    }
+
+    // the weights scaled to a mean of 1, split into the columns below and
+    // above it
+    vector<double> scaled(n);
+    vector<int>    small;
+    vector<int>    large;
+    for(int i = 0; i < n; i++) {
+        scaled[i] = weights[i] * n / total;
+        if(scaled[i] < 1.0) {
+            small.push_back(i);
+        } else {
+            large.push_back(i);
+        }
+    }
+
+    // every small column is topped up from a large one
+    m_threshold.resize(n);
+    m_alias.resize(n);
+    while(!small.empty() && !large.empty()) {
+        int s = small.back();
+        int l = large.back();
+        small.pop_back();
+        m_threshold[s] = scaled[s];
+        m_alias[s]     = l;
+        scaled[l] -= 1.0 - scaled[s];
+        if(scaled[l] < 1.0) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // what is left is full, up to rounding
+    for(size_t i = 0; i < large.size(); i++) {
+        m_threshold[large[i]] = 1.0;
+        m_alias[large[i]]     = large[i];
+    }
+    for(size_t i = 0; i < small.size(); i++) {
+        m_threshold[small[i]] = 1.0;
+        m_alias[small[i]]     = small[i];
+    }
+    return true;
+}
+
+int AliasTable::pick(double u, double& v) const
+{
+    int    n = (int)m_threshold.size();
+    double x = u * n;
+    int    i = (int)x;
+    if(i >= n) {
+        i = n - 1;
+    } else if(i < 0) {
+        i = 0;
+    }
+
+    double f = x - i;
+    double t = m_threshold[i];
+    if((f < t) || (t >= 1.0)) {
+        v = (f < t) ? f / t : 1.0;
+        return i;
+    }
+    v = (f - t) / (1.0 - t);
+    if(v > 1.0) {
+        v = 1.0;
+    }
+    return m_alias[i];
+}
+
+int AliasTable::size() const
+{
+    return (int)m_threshold.size();
+}
+
+} // namespace Utils
+} // namespace CODeM
@@ -0,0 +1,61 @@
+/****************************************************************************
+**
+** The MIT License (MIT)
+**
+** Copyright (c) 2016 The University of Sheffield (www.sheffield.ac.uk)
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in all
+** copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE
+**
+****************************************************************************/
+#ifndef ALIASTABLE_H
+#define ALIASTABLE_H
+
+#include <vector>
+
+namespace CODeM {
+namespace Utils {
+
+/*  A Walker alias table, built with Vose's method, for sampling one of n
+ *  outcomes with given weights in O(1) regardless of n. Each of n equal
+ *  columns holds an outcome up to a threshold and its alias above it, so a
+ *  single uniform value picks a column and a side of its threshold. */
+class AliasTable
+{
+public:
+    AliasTable();
+
+    // Returns false, and leaves the table empty, if a weight is negative or
+    // not finite, or if they sum to zero
+    bool define(const std::vector<double>& weights);
+
+    // The outcome for the uniform value u in [0,1]. v is set to the
+    // position of u within the outcome's share of its column, uniform in
+    // [0,1] and independent of the outcome.
+    int  pick(double u, double& v) const;
+
+    int  size() const;
+
+private:
+    std::vector<double> m_threshold;
+    std::vector<int>    m_alias;
+};
+
+} // namespace Utils
+} // namespace CODeM
+#endif // ALIASTABLE_H
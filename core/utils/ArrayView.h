@@ -0,0 +1,71 @@
+/****************************************************************************
+**
+** The MIT License (MIT)
+**
+** Copyright (c) 2016 The University of Sheffield (www.sheffield.ac.uk)
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in all
+** copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE
+**
+****************************************************************************/
+#ifndef ARRAYVIEW_H
+#define ARRAYVIEW_H
+
+#include <vector>
+#include <cstddef>
+
+namespace CODeM {
+namespace Utils {
+
+// A non-owning, read-only view of contiguous values. It is valid as long as
+// the values it refers to are neither moved nor destroyed.
+template <typename T>
+class ArrayView
+{
+public:
+    typedef const T* const_iterator;
+
+    ArrayView()
+        : m_data(0), m_size(0) {}
+    ArrayView(const T* data, std::size_t size)
+        : m_data(data), m_size(size) {}
+    ArrayView(const T* first, const T* last)
+        : m_data(first), m_size(last - first) {}
+    ArrayView(const std::vector<T>& v)
+        : m_data(v.data()), m_size(v.size()) {}
+
+    const T*       data()                   const {return m_data;}
+    std::size_t    size()                   const {return m_size;}
+    bool           empty()                  const {return m_size == 0;}
+    const T&       operator[](std::size_t i) const {return m_data[i];}
+    const T&       front()                  const {return m_data[0];}
+    const T&       back()                   const {return m_data[m_size-1];}
+    const_iterator begin()                  const {return m_data;}
+    const_iterator end()                    const {return m_data + m_size;}
+
+    std::vector<T> toVector() const {return std::vector<T>(begin(), end());}
+
+private:
+    const T*    m_data;
+    std::size_t m_size;
+};
+
+} // namespace Utils
+} // namespace CODeM
+
+#endif // ARRAYVIEW_H
@@ -0,0 +1,197 @@
+/****************************************************************************
+**
+** The MIT License (MIT)
+**
+** Copyright (c) 2016 The University of Sheffield (www.sheffield.ac.uk)
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in all
+** copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE
+**
+****************************************************************************/
+#include <core/utils/FFT.h>
+#include <core/CODeMGlobal.h>
+
+#include <math.h>
+
+using std::complex;
+using std::vector;
+
+namespace CODeM {
+namespace Utils {
+
+namespace {
+
+// Plain complex product; the std::complex operator also handles infinities,
+// which makes it several times slower
+inline complex<double> mul(const complex<double>& a, const complex<double>& b)
+{
+    return complex<double>(a.real() * b.real() - a.imag() * b.imag(),
+                           a.real() * b.imag() + a.imag() * b.real());
+}
+
+bool isPowerOfTwo(size_t n)
+{
+    return (n > 0) && ((n & (n - 1)) == 0);
+}
+
+size_t nextPowerOfTwo(size_t n)
+{
+    size_t p = 1;
+    while(p < n) {
+        p <<= 1;
+    }
+    return p;
+}
+
+// exp(-2*pi*j*k/n) for k = 0,...,n/2-1
+void twiddleFactors(size_t n, vector<complex<double> >& w)
+{
+    w.resize(n / 2);
+    for(size_t k = 0; k < n / 2; k++) {
+        w[k] = std::polar(1.0, -2.0 * PI * k / n);
+    }
+}
+
+// w are the twiddle factors of length a.size()
+void radix2(vector<complex<double> >& a, const vector<complex<double> >& w,
+            bool inverse)
+{
+    size_t n = a.size();
+
+    // bit reversal permutation
+    for(size_t i = 1, j = 0; i < n; i++) {
+        size_t bit = n >> 1;
+        for(; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if(i < j) {
+            std::swap(a[i], a[j]);
+        }
+    }
+
+    for(size_t len = 2; len <= n; len <<= 1) {
+        size_t half   = len >> 1;
+        size_t stride = n / len;
+        for(size_t i = 0; i < n; i += len) {
+            for(size_t k = 0; k < half; k++) {
+                complex<double> wk = inverse ? std::conj(w[k * stride]) : w[k * stride];
+                complex<double> u  = a[i + k];
+                complex<double> v  = mul(a[i + k + half], wk);
+                a[i + k]        = u + v;
+                a[i + k + half] = u - v;
+            }
+        }
+    }
+}
+
+void bluestein(vector<complex<double> >& a, bool inverse)
+{
+    size_t n = a.size();
+    size_t m = nextPowerOfTwo(2 * n - 1);
+    double sign = inverse ? 1.0 : -1.0;
+
+    // chirp exp(sign*pi*j*k^2/n); k^2 is reduced modulo 2n to keep the
+    // argument small
+    vector<complex<double> > chirp(n);
+    for(size_t k = 0; k < n; k++) {
+        unsigned long long k2 = ((unsigned long long)k * k) % (2 * n);
+        chirp[k] = std::polar(1.0, sign * PI * k2 / n);
+    }
+
+    vector<complex<double> > b(m, complex<double>(0.0, 0.0));
+    vector<complex<double> > c(m, complex<double>(0.0, 0.0));
+    for(size_t k = 0; k < n; k++) {
+        b[k] = mul(a[k], chirp[k]);
+    }
+    c[0] = std::conj(chirp[0]);
+    for(size_t k = 1; k < n; k++) {
+        c[k] = c[m - k] = std::conj(chirp[k]);
+    }
+
+    vector<complex<double> > w;
+    twiddleFactors(m, w);
+    radix2(b, w, false);
+    radix2(c, w, false);
+    for(size_t k = 0; k < m; k++) {
+        b[k] = mul(b[k], c[k]);
+    }
+    radix2(b, w, true);
+
+    for(size_t k = 0; k < n; k++) {
+        a[k] = mul(b[k], chirp[k]) / (double)m;
+    }
+}
+
+} // namespace
+
+void fft(vector<complex<double> >& a, bool inverse)
+{
+    if(a.size() < 2) {
+        return;
+    }
+    if(isPowerOfTwo(a.size())) {
+        vector<complex<double> > w;
+        twiddleFactors(a.size(), w);
+        radix2(a, w, inverse);
+    } else {
+        bluestein(a, inverse);
+    }
+}
+
+void sineTransform(const vector<complex<double> >& x,
+                   vector<complex<double> >&       y)
+{
+    size_t M = x.size();
+    y.assign(M + 1, complex<double>(0.0, 0.0));
+    if(M < 2) {
+        return;
+    }
+
+    // odd extension: X[n] = x[n], X[2M-n] = -x[n], X[0] = X[M] = 0. Then
+    // FFT(X)[i] = -2j * y[i].
+    vector<complex<double> > X(2 * M, complex<double>(0.0, 0.0));
+    for(size_t n = 1; n < M; n++) {
+        X[n]         =  x[n];
+        X[2 * M - n] = -x[n];
+    }
+    fft(X);
+
+    complex<double> halfJ(0.0, 0.5);
+    for(size_t i = 0; i <= M; i++) {
+        y[i] = X[i] * halfJ;
+    }
+}
+
+double fftCost(size_t n)
+{
+    // measured in complex multiply-adds of a direct evaluation; a butterfly
+    // costs about four of them
+    if(n < 2) {
+        return 0.0;
+    }
+    if(isPowerOfTwo(n)) {
+        return 2.0 * n * log2((double)n);
+    }
+    // three power-of-two transforms plus the chirp
+    size_t m = nextPowerOfTwo(2 * n - 1);
+    return 3.0 * 2.0 * m * log2((double)m) + 10.0 * n;
+}
+
+} // namespace Utils
+} // namespace CODeM
@@ -0,0 +1,53 @@
+/****************************************************************************
+**
+** The MIT License (MIT)
+**
+** Copyright (c) 2016 The University of Sheffield (www.sheffield.ac.uk)
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in all
+** copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE
+**
+****************************************************************************/
+#ifndef FFT_H
+#define FFT_H
+
+#include <complex>
+#include <vector>
+#include <cstddef>
+
+namespace CODeM {
+namespace Utils {
+
+// In-place discrete Fourier transform, X[k] = sum_n x[n] exp(-2*pi*j*n*k/N).
+// Powers of two use an iterative radix-2 transform, other lengths Bluestein's
+// chirp-z algorithm, so every length costs O(N log N).
+void fft(std::vector<std::complex<double> >& a, bool inverse = false);
+
+// Discrete sine transform of complex coefficients:
+// y[i] = sum_{n=1}^{M-1} x[n] * sin(pi*n*i/M), for i = 0,...,M, where
+// M = x.size() and x[0] is ignored. Computed with one transform of length 2M.
+void sineTransform(const std::vector<std::complex<double> >& x,
+                   std::vector<std::complex<double> >&       y);
+
+// Rough cost of fft() for a sequence of length n, in units of one
+// coefficient-times-basis-function update of a direct series evaluation
+double fftCost(std::size_t n);
+
+} // namespace Utils
+} // namespace CODeM
+#endif // FFT_H
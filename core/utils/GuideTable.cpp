@@ -0,0 +1,85 @@
+/****************************************************************************
+**
+** The MIT License (MIT)
+**
+** Copyright (c) 2016 The University of Sheffield (www.sheffield.ac.uk)
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in all
+** copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE
+**
+****************************************************************************/
+#include <core/utils/GuideTable.h>
+
+using std::vector;
+
+namespace CODeM {
+namespace Utils {
+
+GuideTable::GuideTable()
+    : m_lastInterval(0)
+{
+
+}
+
+void GuideTable::define(const vector<double>& cdf)
+{
+    m_lastInterval = (int)cdf.size() - 2;
+    if(m_lastInterval < 0) {
+        m_guide.clear();
+        return;
+    }
+
+    int nBuckets = m_lastInterval + 1;
+    m_guide.resize(nBuckets);
+    int j = 0;
+    for(int k = 0; k < nBuckets; k++) {
+        double edge = (double)k / nBuckets;
+        while((j < m_lastInterval) && (cdf[j+1] <= edge)) {
+            ++j;
+        }
+        m_guide[k] = j;
+    }
+}
+
+int GuideTable::bracket(double u, const double* cdf) const
+{
+    int nBuckets = (int)m_guide.size();
+    if(nBuckets == 0) {
+        return 0;
+    }
+    int k = (int)(u * nBuckets);
+    if(k >= nBuckets) {
+        k = nBuckets - 1;
+    } else if(k < 0) {
+        k = 0;
+    }
+
+    int j = m_guide[k];
+    while((j < m_lastInterval) && (cdf[j+1] <= u)) {
+        ++j;
+    }
+    return j;
+}
+
+bool GuideTable::isEmpty() const
+{
+    return m_guide.empty();
+}
+
+} // namespace Utils
+} // namespace CODeM
@@ -0,0 +1,60 @@
+/****************************************************************************
+**
+** The MIT License (MIT)
+**
+** Copyright (c) 2016 The University of Sheffield (www.sheffield.ac.uk)
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in all
+** copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE
+**
+****************************************************************************/
+#ifndef GUIDETABLE_H
+#define GUIDETABLE_H
+
+#include <vector>
+
+namespace CODeM {
+namespace Utils {
+
+/*  A Chen-Asau guide table over a tabulated, normalised cdf. The unit interval
+ *  is divided into as many equal buckets as the cdf has intervals, and every
+ *  bucket stores the interval its lower edge falls in. Inverting the cdf is
+ *  then a bucket lookup followed by a short forward walk, O(1) on average. */
+class GuideTable
+{
+public:
+    GuideTable();
+
+    // Build the table for cdf values with cdf.front() == 0 and cdf.back() == 1
+    void define(const std::vector<double>& cdf);
+
+    // The last j in [0, n-2] with cdf[j] <= u, for u in [0,1]. The same cdf
+    // the table was defined with must be provided. A cdf of fewer than two
+    // values has no intervals: bracket() then returns 0, and there is no
+    // interval to read.
+    int  bracket(double u, const double* cdf) const;
+    bool isEmpty() const;
+
+private:
+    std::vector<int> m_guide;
+    int              m_lastInterval;
+};
+
+} // namespace Utils
+} // namespace CODeM
+#endif // GUIDETABLE_H
@@ -26,22 +26,51 @@
 #include <core/utils/LinearInterpolator.h>
 #include <math.h>
 #include <algorithm>
+#include <utility>
 
+using std::size_t;
 using std::vector;
 
 namespace CODeM {
 namespace Utils {
 
-LinearInterpolator::LinearInterpolator(vector<double> x,
-                                       vector<double> y)
+namespace {
+
+// The value at x of the interval j of the table (xx, yy)
+inline double intervalInterpolate(const double* xx, const double* yy, int j,
+                                  double x)
+{
+    if (xx[j]==xx[j+1]) {
+        return yy[j];
+    }
+
+    return yy[j] + ((x-xx[j])/(xx[j+1]-xx[j]))*(yy[j+1]-yy[j]);
+}
+
+} // namespace
+
+LinearInterpolator::LinearInterpolator(const vector<double>& x,
+                                       const vector<double>& y)
+    : xx(x),
+      yy(y)
+{
+    resetSearch();
+    m_isConfigured = checkConfiguration();
+}
+
+LinearInterpolator::LinearInterpolator(vector<double>&& x, vector<double>&& y)
+    : xx(std::move(x)),
+      yy(std::move(y))
+{
+    resetSearch();
+    m_isConfigured = checkConfiguration();
+}
+
+LinearInterpolator::LinearInterpolator(ArrayView<double> x, ArrayView<double> y)
+    : xx(x.begin(), x.end()),
+      yy(y.begin(), y.end())
 {
-    n    = (int)x.size();
-    mm   = 2;
-    jsav = 0;
-    cor  = 0;
-    xx   = x;
-    yy   = y;
-    dj = std::max(1, static_cast<int>(std::pow(static_cast<double>(n), 0.25)));
+    resetSearch();
     m_isConfigured = checkConfiguration();
 }
 
@@ -52,42 +81,127 @@ LinearInterpolator::~LinearInterpolator()
 
 double LinearInterpolator::interpolate(double xq)
 {
-    int jlo = cor ? hunt(xq) : locate(xq);
+    return interpolate(xq, m_cursor);
+}
+
+vector<double> LinearInterpolator::interpolateV(const vector<double>& xq)
+{
+    return interpolateV(ArrayView<double>(xq), m_cursor);
+}
+
+vector<double> LinearInterpolator::interpolateV(ArrayView<double> xq)
+{
+    return interpolateV(xq, m_cursor);
+}
+
+double LinearInterpolator::interpolate(double xq, Cursor& c) const
+{
+    int jlo = c.cor ? hunt(xq, c) : locate(xq, c);
     return baseInterpolate(jlo, xq);
 }
 
-vector<double> LinearInterpolator::interpolateV(vector<double> xq)
+vector<double> LinearInterpolator::interpolateV(ArrayView<double> xq,
+                                                Cursor& c) const
 {
     vector<double> yq;
     int sz = (int)xq.size();
     yq.resize(sz);
+    if(isIncreasing()) {
+        interpolate(xq.size(), xq.data(), yq.data());
+        return yq;
+    }
     for(int i=0; i<sz; i++) {
-        yq[i] = interpolate(xq[i]);
+        yq[i] = interpolate(xq[i], c);
     }
 
     return yq;
 }
 
-void LinearInterpolator::defineXY(vector<double> x, vector<double> y)
+void LinearInterpolator::interpolate(size_t nq, const double* xq,
+                                     double* yq) const
+{
+    if(!isIncreasing()) {
+        Cursor c;
+        for(size_t i=0; i<nq; i++) {
+            yq[i] = interpolate(xq[i], c);
+        }
+        return;
+    }
+
+    size_t sorted = 1;
+    while((sorted < nq) && (xq[sorted] >= xq[sorted-1])) {
+        ++sorted;
+    }
+    if(sorted >= nq) {
+        interpolateSorted(nq, xq, yq);
+        return;
+    }
+
+    // the intervals of a block are found first, so the interpolation pass
+    // has no searches and no dependencies between the queries
+    const size_t blockSize = 256;
+    int j[blockSize];
+    for(size_t start = 0; start < nq; start += blockSize) {
+        size_t m = std::min(blockSize, nq - start);
+        const double* x = xq + start;
+        double*       y = yq + start;
+        for(size_t i=0; i<m; i++) {
+            j[i] = branchFreeLocate(x[i]);
+        }
+        for(size_t i=0; i<m; i++) {
+            y[i] = baseInterpolate(j[i], x[i]);
+        }
+    }
+}
+
+void LinearInterpolator::interpolateSorted(size_t nq, const double* xq,
+                                           double* yq) const
+{
+    if(!isIncreasing()) {
+        interpolate(nq, xq, yq);
+        return;
+    }
+
+    Utils::interpolateSorted(xx, yy, nq, xq, yq);
+}
+
+void LinearInterpolator::defineXY(const vector<double>& x,
+                                  const vector<double>& y)
 {
     if(x.size() == y.size()) {
         xx = x;
         yy = y;
-        n  = (int)x.size();
-        jsav = 0;
-        cor  = 0;
-        dj = std::max(1, static_cast<int>(std::pow(static_cast<double>(n), 0.25)));
+        resetSearch();
         m_isConfigured = true;
     }
 
 }
 
+void LinearInterpolator::defineXY(vector<double>&& x, vector<double>&& y)
+{
+    if(x.size() == y.size()) {
+        xx = std::move(x);
+        yy = std::move(y);
+        resetSearch();
+        m_isConfigured = true;
+    }
+
+}
+
+void LinearInterpolator::resetSearch()
+{
+    n        = (int)xx.size();
+    mm       = 2;
+    m_cursor = Cursor();
+    dj       = std::max(1, static_cast<int>(std::pow(static_cast<double>(n), 0.25)));
+}
+
 bool LinearInterpolator::isConfigured()
 {
     return m_isConfigured;
 }
 
-int LinearInterpolator::locate(const double x)
+int LinearInterpolator::locate(const double x, Cursor& c) const
 {
     int ju, jm, jl;
     bool ascnd=(xx[n-1] >= xx[0]);
@@ -100,14 +214,14 @@ int LinearInterpolator::locate(const double x)
         else
             ju=jm;
     }
-    cor = std::abs(jl-jsav) > dj ? 0 : 1;
-    jsav = jl;
+    c.cor = std::abs(jl-c.jsav) > dj ? 0 : 1;
+    c.jsav = jl;
     return std::max(0, std::min(n-mm, jl-((mm-2)>>1)));
 }
 
-int LinearInterpolator::hunt(const double x)
+int LinearInterpolator::hunt(const double x, Cursor& c) const
 {
-    int jl=jsav, jm, ju, inc=1;
+    int jl=c.jsav, jm, ju, inc=1;
     bool ascnd=(xx[n-1] >= xx[0]);
     if (jl < 0 || jl > n-1) {
         jl=0;
@@ -143,11 +257,31 @@ int LinearInterpolator::hunt(const double x)
         else
             ju=jm;
     }
-    cor = std::abs(jl-jsav) > dj ? 0 : 1;
-    jsav = jl;
+    c.cor = std::abs(jl-c.jsav) > dj ? 0 : 1;
+    c.jsav = jl;
     return std::max(0, std::min(n-mm, jl-((mm-2) >> 1)));
 }
 
+int LinearInterpolator::branchFreeLocate(double x) const
+{
+    // the number of xx[1],...,xx[n-2] that are not above x
+    const double* first = xx.data() + 1;
+    const double* base  = first;
+    int len = n - 2;
+    while(len > 0) {
+        int  half  = len >> 1;
+        bool below = base[half] <= x;
+        base += below ? half + 1 : 0;
+        len   = below ? len - half - 1 : half;
+    }
+    return (int)(base - first);
+}
+
+bool LinearInterpolator::isIncreasing() const
+{
+    return (n >= 2) && (xx[n-1] >= xx[0]);
+}
+
 bool LinearInterpolator::checkConfiguration()
 {
     bool status = false;
@@ -158,13 +292,32 @@ bool LinearInterpolator::checkConfiguration()
     return status;
 }
 
-double LinearInterpolator::baseInterpolate(int j, double x)
+double LinearInterpolator::baseInterpolate(int j, double x) const
 {
-    if (xx[j]==xx[j+1]) {
-        return yy[j];
+    return intervalInterpolate(xx.data(), yy.data(), j, x);
+}
+
+void interpolateSorted(ArrayView<double> x, ArrayView<double> y,
+                       size_t nq, const double* xq, double* yq)
+{
+    int n = (int)std::min(x.size(), y.size());
+    if(n < 2) {
+        std::fill(yq, yq + nq, (n == 1) ? y[0] : 0.0);
+        return;
     }
 
-    return yy[j] + ((x-xx[j])/(xx[j+1]-xx[j]))*(yy[j+1]-yy[j]);
+    // one walk through the table, the intervals only moving forward
+    const double* xx = x.data();
+    const double* yy = y.data();
+    int j = 0;
+    int last = n - 2;
+    for(size_t i=0; i<nq; i++) {
+        double xi = xq[i];
+        while((j < last) && (xi >= xx[j+1])) {
+            ++j;
+        }
+        yq[i] = intervalInterpolate(xx, yy, j, xi);
+    }
 }
 
 } // namespace Utils
@@ -27,8 +27,10 @@
 #define LINEARINTERPOLATOR_H
 
 #include <core/CODeMGlobal.h>
+#include <core/utils/ArrayView.h>
 
 #include <vector>
+#include <cstddef>
 
 namespace CODeM {
 namespace Utils {
@@ -36,30 +38,72 @@ namespace Utils {
 class LinearInterpolator
 {
 public:
-    LinearInterpolator(std::vector<double> xv, std::vector<double> yv);
+    // The state of a search through the table. Queries close to the
+    // previous one hunt from its interval instead of bisecting the whole
+    // table. A cursor belongs to one thread; the const functions can be
+    // used from several threads, each with its own cursor.
+    struct Cursor
+    {
+        Cursor() : jsav(0), cor(0) {}
+
+        int jsav;
+        int cor;
+    };
+
+    // The tables are copied, or moved in when given as temporaries. Views
+    // are copied too; interpolateSorted() below borrows its tables.
+    LinearInterpolator(const std::vector<double>& xv,
+                       const std::vector<double>& yv);
+    LinearInterpolator(std::vector<double>&& xv, std::vector<double>&& yv);
+    LinearInterpolator(ArrayView<double> xv, ArrayView<double> yv);
     ~LinearInterpolator();
 
+    // With the interpolator's own cursor
     double interpolate(double xq);
-    std::vector<double> interpolateV(std::vector<double> xq);
-    virtual void defineXY(std::vector<double> x, std::vector<double> y);
+    std::vector<double> interpolateV(const std::vector<double>& xq);
+    std::vector<double> interpolateV(ArrayView<double> xq);
+
+    double interpolate(double xq, Cursor& c) const;
+    std::vector<double> interpolateV(ArrayView<double> xq, Cursor& c) const;
+    // The values at the n queries xq, into yq. Increasing tables are
+    // interpolated without cursors: non-decreasing queries in one merge pass
+    // over the table, others by a branch-free search per query followed by
+    // a pass that gathers the intervals.
+    void   interpolate(std::size_t n, const double* xq, double* yq) const;
+    // The same, for queries known to be non-decreasing
+    void   interpolateSorted(std::size_t n, const double* xq, double* yq) const;
+
+    virtual void defineXY(const std::vector<double>& x,
+                          const std::vector<double>& y);
+    virtual void defineXY(std::vector<double>&& x, std::vector<double>&& y);
     bool isConfigured();
 
 protected:
-    double baseInterpolate(int j, double x);
-    int locate(const double x);
-    int hunt(const double x);
+    // resets the search state for new tables
+    void resetSearch();
+    double baseInterpolate(int j, double x) const;
+    int locate(const double x, Cursor& c) const;
+    int hunt(const double x, Cursor& c) const;
+    // The same as locate() in an increasing table, without branches
+    int branchFreeLocate(double x) const;
+    bool isIncreasing() const;
     virtual bool checkConfiguration();
 
-    int  n;
-    int  mm;
-    int  jsav;
-    int  cor;
-    int  dj;
-    bool m_isConfigured;
+    int    n;
+    int    mm;
+    int    dj;
+    Cursor m_cursor;
+    bool   m_isConfigured;
     std::vector<double> xx;
     std::vector<double> yy;
 };
 
+// The table (x, y), increasing in x, at the nq non-decreasing queries xq,
+// into yq, in one walk through the table. The table is read in place,
+// without building an interpolator.
+void interpolateSorted(ArrayView<double> x, ArrayView<double> y,
+                       std::size_t nq, const double* xq, double* yq);
+
 } // namespace Utils
 } // namespace CODeM
 #endif // LINEARINTERPOLATOR_H
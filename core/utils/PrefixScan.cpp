@@ -0,0 +1,100 @@
+/****************************************************************************
+**
+** The MIT License (MIT)
+**
+** Copyright (c) 2016 The University of Sheffield (www.sheffield.ac.uk)
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in all
+** copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE
+**
+****************************************************************************/
+#include <core/utils/PrefixScan.h>
+
+using std::size_t;
+
+namespace CODeM {
+namespace Utils {
+
+namespace {
+
+// out[i] = the area of the interval ending at x[i], for i = 1,...,n-1
+inline void trapezoidAreas(const double* x, const double* y, size_t n,
+                           double* out)
+{
+    out[0] = 0.0;
+    for(size_t i=1; i<n; i++) {
+        out[i] = (y[i-1] + y[i]) / 2.0 * (x[i] - x[i-1]);
+    }
+}
+
+} // namespace
+
+double trapezoidScan(const double* x, const double* y, size_t n, double* out)
+{
+    if(n == 0) {
+        return 0.0;
+    }
+    trapezoidAreas(x, y, n, out);
+
+    double sum = 0.0;
+    for(size_t i=1; i<n; i++) {
+        sum += out[i];
+        out[i] = sum;
+    }
+    return sum;
+}
+
+double blockedTrapezoidScan(const double* x, const double* y, size_t n,
+                            double* out)
+{
+    size_t blockSize = (n + ScanBlocks - 1) / ScanBlocks;
+    if(blockSize < 2) {
+        return trapezoidScan(x, y, n, out);
+    }
+    trapezoidAreas(x, y, n, out);
+
+    // the running sums of the blocks, interleaved so that the additions of
+    // different blocks do not wait for each other
+    double sums[ScanBlocks] = {0.0};
+    for(size_t i=0; i<blockSize; i++) {
+        for(int b=0; b<ScanBlocks; b++) {
+            size_t k = b * blockSize + i;
+            if(k < n) {
+                sums[b] += out[k];
+                out[k] = sums[b];
+            }
+        }
+    }
+
+    // offset every block by the total of the blocks before it
+    double offset = 0.0;
+    for(int b=0; b<ScanBlocks; b++) {
+        size_t first = b * blockSize;
+        size_t last  = first + blockSize < n ? first + blockSize : n;
+        if(b > 0) {
+            for(size_t k=first; k<last; k++) {
+                out[k] += offset;
+            }
+        }
+        offset += sums[b];
+    }
+    return out[n-1];
+}
+
+} // namespace Utils
+} // namespace CODeM
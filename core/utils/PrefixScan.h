@@ -0,0 +1,52 @@
+/****************************************************************************
+**
+** The MIT License (MIT)
+**
+** Copyright (c) 2016 The University of Sheffield (www.sheffield.ac.uk)
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in all
+** copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE
+**
+****************************************************************************/
+#ifndef PREFIXSCAN_H
+#define PREFIXSCAN_H
+
+#include <cstddef>
+
+namespace CODeM {
+namespace Utils {
+
+// The running trapezoid integral of y over x: out[0] = 0 and out[i] is the
+// integral up to x[i]. Returns the total. The interval areas are computed
+// in an independent, vectorisable pass before the running sum.
+double trapezoidScan(const double* x, const double* y, std::size_t n,
+                     double* out);
+
+// The same integral, with the running sum split into ScanBlocks blocks that
+// are summed as independent chains and then offset by the totals of the
+// blocks before them. For long grids; the sums are ordered differently, so
+// the results may differ from trapezoidScan() in the last bits.
+double blockedTrapezoidScan(const double* x, const double* y, std::size_t n,
+                            double* out);
+
+const int ScanBlocks(8);
+
+} // namespace Utils
+} // namespace CODeM
+
+#endif // PREFIXSCAN_H
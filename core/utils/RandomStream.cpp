@@ -0,0 +1,244 @@
+/****************************************************************************
+**
+** The MIT License (MIT)
+**
+** Copyright (c) 2016 The University of Sheffield (www.sheffield.ac.uk)
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in all
+** copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE
+**
+****************************************************************************/
+#include <core/utils/RandomStream.h>
+
+#include <atomic>
+#include <algorithm>
+#include <cassert>
+
+namespace CODeM {
+namespace Utils {
+
+namespace {
+
+const uint32_t PhiloxM0(0xD2511F53u);
+const uint32_t PhiloxM1(0xCD9E8D57u);
+const uint32_t PhiloxW0(0x9E3779B9u);
+const uint32_t PhiloxW1(0xBB67AE85u);
+const int      PhiloxRounds(10);
+
+// Solutions handed out by nextRandomStream() live in the upper half of the
+// index space, so they never collide with explicitly indexed solutions.
+const uint64_t AnonymousSolutionFlag(uint64_t(1) << 63);
+const uint64_t GlobalSolution(AnonymousSolutionFlag - 1);
+
+uint64_t              g_seed(0);
+std::atomic<uint64_t> g_nextSolution(0);
+
+// Philox4x32-10 over a group of independent counters. The lanes are kept in
+// separate arrays so the rounds vectorise across blocks.
+template<int L>
+inline void philox4x32(uint32_t c0[L], uint32_t c1[L], uint32_t c2[L],
+                       uint32_t c3[L], uint32_t k0, uint32_t k1)
+{
+    for(int r = 0; r < PhiloxRounds; ++r) {
+        for(int l = 0; l < L; ++l) {
+            uint64_t p0 = uint64_t(PhiloxM0) * c0[l];
+            uint64_t p1 = uint64_t(PhiloxM1) * c2[l];
+            uint32_t n0 = uint32_t(p1 >> 32) ^ c1[l] ^ k0;
+            uint32_t n2 = uint32_t(p0 >> 32) ^ c3[l] ^ k1;
+            c1[l] = uint32_t(p1);
+            c3[l] = uint32_t(p0);
+            c0[l] = n0;
+            c2[l] = n2;
+        }
+        k0 += PhiloxW0;
+        k1 += PhiloxW1;
+    }
+}
+
+// 53 random bits to a double in [0,1)
+inline double toUnitInterval(uint32_t hi, uint32_t lo)
+{
+    uint64_t bits = ((uint64_t(hi) << 32) | lo) >> 11;
+    return bits * (1.0 / 9007199254740992.0);
+}
+
+} // namespace
+
+RandomStream::RandomStream()
+    : m_seed(0),
+      m_solution(0),
+      m_substream(0),
+      m_position(0),
+      m_bufferStart(0),
+      m_bufferEnd(0)
+{
+
+}
+
+RandomStream::RandomStream(uint64_t seed, uint64_t solution, uint32_t substream)
+    : m_seed(seed),
+      m_solution(solution),
+      m_substream(substream),
+      m_position(0),
+      m_bufferStart(0),
+      m_bufferEnd(0)
+{
+
+}
+
+double RandomStream::uniform()
+{
+    if((m_position < m_bufferStart) || (m_position >= m_bufferEnd)) {
+        refill();
+    }
+    return m_buffer[m_position++ - m_bufferStart];
+}
+
+void RandomStream::fill(double* out, std::size_t n)
+{
+    while(n > 0) {
+        if((m_position >= m_bufferStart) && (m_position < m_bufferEnd)) {
+            // drain the buffered values first
+            uint64_t    offset = m_position - m_bufferStart;
+            std::size_t nCopy  = std::min<std::size_t>(n, m_bufferEnd - m_position);
+            std::copy(m_buffer + offset, m_buffer + offset + nCopy, out);
+            out        += nCopy;
+            n          -= nCopy;
+            m_position += nCopy;
+        } else if((n >= 2 * Lanes) && ((m_position & 1) == 0)) {
+            // whole groups of blocks go straight to the output
+            generateLanes(m_position >> 1, out);
+            out        += 2 * Lanes;
+            n          -= 2 * Lanes;
+            m_position += 2 * Lanes;
+        } else if(n < 2 * Lanes) {
+            // a short fill computes only the blocks it uses
+            refill(int(((m_position & 1) + n + 1) >> 1));
+        } else {
+            refill();
+        }
+    }
+}
+
+RandomStream RandomStream::substream(uint32_t idx) const
+{
+    return RandomStream(m_seed, m_solution, idx);
+}
+
+void RandomStream::seek(uint64_t n)
+{
+    assert(n <= MaxPosition);
+    m_position = n;
+}
+
+uint64_t RandomStream::position() const
+{
+    return m_position;
+}
+
+uint64_t RandomStream::seed() const
+{
+    return m_seed;
+}
+
+uint64_t RandomStream::solution() const
+{
+    return m_solution;
+}
+
+uint32_t RandomStream::substreamIndex() const
+{
+    return m_substream;
+}
+
+void RandomStream::refill(int nBlocks)
+{
+    uint64_t firstBlock = m_position >> 1;
+    // the last blocks of a substream are computed one at a time
+    uint64_t available  = (MaxPosition >> 1) - std::min(firstBlock,
+                                                        MaxPosition >> 1);
+    assert(available > 0);
+    nBlocks = (int)std::min<uint64_t>(nBlocks, available);
+    if(nBlocks >= Lanes) {
+        nBlocks = Lanes;
+        generateLanes(firstBlock, m_buffer);
+    } else {
+        for(int b = 0; b < nBlocks; ++b) {
+            generateBlock(firstBlock + b, m_buffer + 2 * b);
+        }
+    }
+    m_bufferStart = 2 * firstBlock;
+    m_bufferEnd   = m_bufferStart + 2 * nBlocks;
+}
+
+void RandomStream::generateLanes(uint64_t firstBlock, double* out) const
+{
+    // counter: (block, substream, solution); 2^32 blocks per substream, so
+    // a block past them would repeat the start of the substream
+    assert(firstBlock + Lanes <= (MaxPosition >> 1));
+    uint32_t c0[Lanes], c1[Lanes], c2[Lanes], c3[Lanes];
+    for(int l = 0; l < Lanes; ++l) {
+        c0[l] = uint32_t(firstBlock + l);
+        c1[l] = m_substream;
+        c2[l] = uint32_t(m_solution);
+        c3[l] = uint32_t(m_solution >> 32);
+    }
+    philox4x32<Lanes>(c0, c1, c2, c3, uint32_t(m_seed), uint32_t(m_seed >> 32));
+    for(int l = 0; l < Lanes; ++l) {
+        out[2 * l]     = toUnitInterval(c0[l], c1[l]);
+        out[2 * l + 1] = toUnitInterval(c2[l], c3[l]);
+    }
+}
+
+void RandomStream::generateBlock(uint64_t block, double* out) const
+{
+    assert(block < (MaxPosition >> 1));
+    uint32_t c0[1] = {uint32_t(block)};
+    uint32_t c1[1] = {m_substream};
+    uint32_t c2[1] = {uint32_t(m_solution)};
+    uint32_t c3[1] = {uint32_t(m_solution >> 32)};
+    philox4x32<1>(c0, c1, c2, c3, uint32_t(m_seed), uint32_t(m_seed >> 32));
+    out[0] = toUnitInterval(c0[0], c1[0]);
+    out[1] = toUnitInterval(c2[0], c3[0]);
+}
+
+RandomStream& globalRandomStream()
+{
+    static RandomStream stream(0, GlobalSolution);
+    return stream;
+}
+
+void defineRandomSeed(uint64_t seed)
+{
+    g_seed = seed;
+    g_nextSolution = 0;
+    globalRandomStream() = RandomStream(seed, GlobalSolution);
+}
+
+uint64_t randomSeed()
+{
+    return g_seed;
+}
+
+RandomStream nextRandomStream()
+{
+    return RandomStream(g_seed, AnonymousSolutionFlag | g_nextSolution++);
+}
+
+} // namespace Utils
+} // namespace CODeM
@@ -0,0 +1,102 @@
+/****************************************************************************
+**
+** The MIT License (MIT)
+**
+** Copyright (c) 2016 The University of Sheffield (www.sheffield.ac.uk)
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in all
+** copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE
+**
+****************************************************************************/
+#ifndef RANDOMSTREAM_H
+#define RANDOMSTREAM_H
+
+#include <cstdint>
+#include <cstddef>
+
+namespace CODeM {
+namespace Utils {
+
+/*  A counter-based pseudo-random stream built on the Philox4x32-10 generator
+ *  (Salmon et al., SC'11). The key is derived from the seed and the counter
+ *  from (solution, substream, position), so every value is a pure function of
+ *  these indices: a stream can be created, copied and positioned anywhere
+ *  without sharing state with other streams or threads. */
+class RandomStream
+{
+public:
+    RandomStream();
+    RandomStream(uint64_t seed, uint64_t solution = 0, uint32_t substream = 0);
+
+    // A uniform random number in [0,1)
+    double       uniform();
+    // n consecutive uniform random numbers; the same values as n calls to
+    // uniform(), generated several blocks at a time
+    void         fill(double* out, std::size_t n);
+
+    // A stream with the same seed and solution, positioned at the first
+    // value of another substream
+    RandomStream substream(uint32_t idx) const;
+
+    // Random access: the next call to uniform() returns the n-th value.
+    // A substream has MaxPosition values; reading past them is an error
+    // rather than a wrap to the first value.
+    void         seek(uint64_t n);
+    uint64_t     position()  const;
+
+    uint64_t     seed()      const;
+    uint64_t     solution()  const;
+    uint32_t     substreamIndex() const;
+
+    // Number of generator blocks computed together, two values each
+    static const int Lanes = 8;
+    // The values of a substream: 2^32 blocks, two values each
+    static const uint64_t MaxPosition = uint64_t(2) << 32;
+
+private:
+    void         generateLanes(uint64_t firstBlock, double* out) const;
+    void         generateBlock(uint64_t block, double* out) const;
+    // Buffer the nBlocks (at most Lanes) blocks from the current position
+    void         refill(int nBlocks = Lanes);
+
+    uint64_t m_seed;
+    uint64_t m_solution;
+    uint32_t m_substream;
+    uint64_t m_position;
+    // The buffered values cover the positions [m_bufferStart, m_bufferEnd)
+    double   m_buffer[2 * Lanes];
+    uint64_t m_bufferStart;
+    uint64_t m_bufferEnd;
+};
+
+// The process-wide stream used by randUni(). It is not thread safe and is
+// kept for callers that do not manage their own streams.
+RandomStream& globalRandomStream();
+
+// Reset the global stream and the seed returned by randomSeed()
+void     defineRandomSeed(uint64_t seed);
+uint64_t randomSeed();
+
+// A fresh stream from the global seed, for callers that do not track the
+// solution index. Every call returns a different solution stream.
+RandomStream nextRandomStream();
+
+} // namespace Utils
+} // namespace CODeM
+
+#endif // RANDOMSTREAM_H
@@ -34,38 +34,97 @@ namespace Utils {
 
 double magnitudeP(const vector<double> &vec, double p)
 {
-    double magnitude = 0.0;
-    for(int i=0; i < vec.size(); i++) {
-        magnitude += pow(vec[i], p);
+    return magnitudeP(vec.data(), (int)vec.size(), p);
+}
+
+namespace {
+
+template <NormType N>
+double distanceKernel(const double* m, const double* c, int n, double p)
+{
+    double acc = 0.0;
+    for(int i=0; i < n; i++) {
+        acc = NormKernel<N>::accumulate(acc, m[i] - c[i], p);
     }
-    magnitude = pow(magnitude, 1.0 / p);
+    return NormKernel<N>::finish(acc, p);
+}
 
-    return magnitude;
+template <NormType N>
+double boxedLengthKernel(const double* dir, int n, double maxComponent,
+                         double p)
+{
+    double acc = 0.0;
+    for(int i=0; i < n; i++) {
+        acc = NormKernel<N>::accumulate(acc, dir[i] / maxComponent, p);
+    }
+    return NormKernel<N>::finish(acc, p);
+}
+
+} // namespace
+
+NormType normType(double p)
+{
+    if(p == 1.0) {
+        return OneNorm;
+    } else if(p == 2.0) {
+        return TwoNorm;
+    } else if(p == HUGE_VAL) {
+        return MaxNorm;
+    }
+    return GeneralNorm;
+}
+
+double magnitudeP(const double* vec, int n, double p)
+{
+    switch(normType(p)) {
+    case OneNorm:
+        return normP<OneNorm>(vec, n, p);
+    case TwoNorm:
+        return normP<TwoNorm>(vec, n, p);
+    case MaxNorm:
+        return normP<MaxNorm>(vec, n, p);
+    default:
+        return normP<GeneralNorm>(vec, n, p);
+    }
 }
 
 void toUnitVec(vector<double>& vec, double norm)
 {
-    double magnitude = magnitudeP(vec, norm);
-    scale(vec, 1.0/magnitude);
+    toUnitVec(vec.data(), (int)vec.size(), norm);
+}
+
+void toUnitVec(double* vec, int n, double norm)
+{
+    double magnitude = magnitudeP(vec, n, norm);
+    scale(vec, n, 1.0/magnitude);
 }
 
 double distanceP(const vector<double> &m, const vector<double> &c, double p)
 {
-    double dist = 0.0;
-    if(m.size() == c.size()) {
-        for(int i=0; i<m.size(); i++) {
-            dist += pow(abs(m[i] - c[i]), p);
-        }
-        dist = pow(dist, 1.0 / p);
-        return dist;
-    } else {
+    if(m.size() != c.size()) {
         return -1.0;
     }
+    int n = (int)m.size();
+    switch(normType(p)) {
+    case OneNorm:
+        return distanceKernel<OneNorm>(m.data(), c.data(), n, p);
+    case TwoNorm:
+        return distanceKernel<TwoNorm>(m.data(), c.data(), n, p);
+    case MaxNorm:
+        return distanceKernel<MaxNorm>(m.data(), c.data(), n, p);
+    default:
+        return distanceKernel<GeneralNorm>(m.data(), c.data(), n, p);
+    }
 }
 
 void scale(vector<double>& vec, double factor)
 {
-    for(int i=0; i < vec.size(); i++) {
+    scale(vec.data(), (int)vec.size(), factor);
+}
+
+void scale(double* vec, int n, double factor)
+{
+    for(int i=0; i < n; i++) {
         vec[i] *= factor;
     }
 }
@@ -110,7 +169,14 @@ void normaliseToUnitBox(vector<double>& vec,
 void scaleBackFromUnitBox(vector<double>& vec,
                           const vector<double> &lBounds, const vector<double> &uBounds)
 {
-    for(int i=0; i < vec.size(); i++) {
+    scaleBackFromUnitBox(vec.data(), (int)vec.size(), lBounds.data(),
+                         uBounds.data());
+}
+
+void scaleBackFromUnitBox(double* vec, int n,
+                          const double* lBounds, const double* uBounds)
+{
+    for(int i=0; i < n; i++) {
         if(vec[i] > 1.0) {
             vec[i] = uBounds[i] - (1.0 - vec[i]) * (uBounds[i] - lBounds[i]);
         } else if(vec[i] < 0.0) {
@@ -121,6 +187,50 @@ void scaleBackFromUnitBox(vector<double>& vec,
     }
 }
 
+void normaliseToUnitBox(double* block, int nRows, int nCols,
+                        const double* lBounds, const double* uBounds)
+{
+    vector<double> ranges(nCols);
+    for(int j=0; j < nCols; j++) {
+        ranges[j] = uBounds[j] - lBounds[j];
+    }
+    const double* range = ranges.data();
+
+    // the same values as the vector version: values at or below the lower
+    // bound are set to 0, then values at or above the upper bound to 1
+    for(int i=0; i < nRows; i++) {
+        double* row = block + (size_t)i * nCols;
+        for(int j=0; j < nCols; j++) {
+            double v = row[j];
+            double x = (v - lBounds[j]) / range[j];
+            x = (v >= uBounds[j]) ? 1.0 : x;
+            row[j] = (v <= lBounds[j]) ? 0.0 : x;
+        }
+    }
+}
+
+void scaleBackFromUnitBox(double* block, int nRows, int nCols,
+                          const double* lBounds, const double* uBounds)
+{
+    vector<double> ranges(nCols);
+    for(int j=0; j < nCols; j++) {
+        ranges[j] = uBounds[j] - lBounds[j];
+    }
+    const double* range = ranges.data();
+
+    // the same values as the vector version: below the box the value is
+    // reflected, above it extended from the upper bound
+    for(int i=0; i < nRows; i++) {
+        double* row = block + (size_t)i * nCols;
+        for(int j=0; j < nCols; j++) {
+            double x     = row[j];
+            double below = lBounds[j] + fabs(x) * range[j];
+            double above = uBounds[j] - (1.0 - x) * range[j];
+            row[j] = (x > 1.0) ? above : below;
+        }
+    }
+}
+
 double directedBoxedIntervalLength(const vector<double> &dir, double p)
 {
     double maxComponent = 0.0;
@@ -129,12 +239,18 @@ double directedBoxedIntervalLength(const vector<double> &dir, double p)
             maxComponent = dir[i];
         }
     }
-    double len = 0.0;
-    for(int i=0; i < dir.size(); i++) {
-        len += pow((dir[i] / maxComponent), p);
+    const double* d = dir.data();
+    int n = (int)dir.size();
+    switch(normType(p)) {
+    case OneNorm:
+        return boxedLengthKernel<OneNorm>(d, n, maxComponent, p);
+    case TwoNorm:
+        return boxedLengthKernel<TwoNorm>(d, n, maxComponent, p);
+    case MaxNorm:
+        return boxedLengthKernel<MaxNorm>(d, n, maxComponent, p);
+    default:
+        return boxedLengthKernel<GeneralNorm>(d, n, maxComponent, p);
     }
-    len = pow(len, 1.0 / p);
-    return len;
 }
 
 } // namespace Utils
@@ -28,21 +28,85 @@
 
 #include <core/CODeMGlobal.h>
 #include <vector>
+#include <math.h>
+#include <algorithm>
 
 using std::vector;
 namespace CODeM {
 namespace Utils {
 
+// The p-norms, specialised at compile time for p = 1, 2 and infinity. A
+// GeneralNorm calls pow() with the p given at run time.
+enum NormType {GeneralNorm, OneNorm, TwoNorm, MaxNorm};
+
+// The NormType of p. p = HUGE_VAL is the maximum norm.
+NormType normType(double p);
+
+// accumulate() adds the contribution of x to acc, starting from 0, and
+// finish() turns the accumulated value into the norm
+template <NormType N>
+struct NormKernel
+{
+    static double accumulate(double acc, double x, double p)
+    {
+        return acc + pow(fabs(x), p);
+    }
+    static double finish(double acc, double p) {return pow(acc, 1.0 / p);}
+};
+
+template <>
+struct NormKernel<OneNorm>
+{
+    static double accumulate(double acc, double x, double)
+    {
+        return acc + fabs(x);
+    }
+    static double finish(double acc, double) {return acc;}
+};
+
+template <>
+struct NormKernel<TwoNorm>
+{
+    static double accumulate(double acc, double x, double)
+    {
+        return acc + x * x;
+    }
+    static double finish(double acc, double) {return sqrt(acc);}
+};
+
+template <>
+struct NormKernel<MaxNorm>
+{
+    static double accumulate(double acc, double x, double)
+    {
+        return std::max(acc, fabs(x));
+    }
+    static double finish(double acc, double) {return acc;}
+};
+
+template <NormType N>
+double normP(const double* vec, int n, double p)
+{
+    double acc = 0.0;
+    for(int i=0; i < n; i++) {
+        acc = NormKernel<N>::accumulate(acc, vec[i], p);
+    }
+    return NormKernel<N>::finish(acc, p);
+}
+
 // Returns the p-norm of the vector
 double magnitudeP(const vector<double>& vec, double p = 2.0);
+double magnitudeP(const double* vec, int n, double p = 2.0);
 
 void toUnitVec(vector<double>& vec, double norm = 2.0);
+void toUnitVec(double* vec, int n, double norm = 2.0);
 
 // The p-norm of the difference between two vectors
 double distanceP(const vector<double> &m, const vector<double> &c, double p=2.0);
 
 // The vector is scaled by a factor
 void scale(vector<double>& dir, double factor);
+void scale(double* dir, int n, double factor);
 
 // The vector is normlaised to be within a unit hyperbox,
 // where the ideal and the anti-ideal are set to 0 and 1, respectively.
@@ -55,6 +119,16 @@ void normaliseToUnitBox(vector<double>& vec,
 
 void scaleBackFromUnitBox(vector<double>& normVec,
                           const vector<double> &lBounds, const vector<double> &uBounds);
+void scaleBackFromUnitBox(double* normVec, int n,
+                          const double* lBounds, const double* uBounds);
+
+// The same for all the rows of a row-major block of nRows x nCols values,
+// with the bounds of every column. The loops have no branches, and the
+// values are the same as those of the vector version.
+void normaliseToUnitBox(double* block, int nRows, int nCols,
+                        const double* lBounds, const double* uBounds);
+void scaleBackFromUnitBox(double* block, int nRows, int nCols,
+                          const double* lBounds, const double* uBounds);
 
 // The length of a vector passing through the 1-norm direction vector dir,
 // ending at the boundary of the unit box.
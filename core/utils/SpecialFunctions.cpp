@@ -0,0 +1,235 @@
+/****************************************************************************
+**
+** The MIT License (MIT)
+**
+** Copyright (c) 2016 The University of Sheffield (www.sheffield.ac.uk)
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in all
+** copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE
+**
+****************************************************************************/
+#include <core/utils/SpecialFunctions.h>
+#include <core/CODeMGlobal.h>
+
+#include <math.h>
+#include <algorithm>
+
+namespace CODeM {
+namespace Utils {
+
+namespace {
+
+const double Epsilon(1e-15);
+const double Tiny(1e-300);
+const int    MaxIterations(300);
+
+// The continued fraction of the incomplete beta function, by the modified
+// Lentz method. Converges quickly for x < (a+1)/(a+b+2).
+double betaContinuedFraction(double a, double b, double x)
+{
+    double qab = a + b;
+    double qap = a + 1.0;
+    double qam = a - 1.0;
+    double c = 1.0;
+    double d = 1.0 - qab * x / qap;
+    if(fabs(d) < Tiny) {
+        d = Tiny;
+    }
+    d = 1.0 / d;
+    double h = d;
+    for(int m = 1; m <= MaxIterations; m++) {
+        int    m2 = 2 * m;
+        // the even step
+        double aa = m * (b - m) * x / ((qam + m2) * (a + m2));
+        d = 1.0 + aa * d;
+        if(fabs(d) < Tiny) {
+            d = Tiny;
+        }
+        c = 1.0 + aa / c;
+        if(fabs(c) < Tiny) {
+            c = Tiny;
+        }
+        d  = 1.0 / d;
+        h *= d * c;
+        // the odd step
+        aa = -(a + m) * (qab + m) * x / ((a + m2) * (qap + m2));
+        d = 1.0 + aa * d;
+        if(fabs(d) < Tiny) {
+            d = Tiny;
+        }
+        c = 1.0 + aa / c;
+        if(fabs(c) < Tiny) {
+            c = Tiny;
+        }
+        d = 1.0 / d;
+        double del = d * c;
+        h *= del;
+        if(fabs(del - 1.0) < Epsilon) {
+            break;
+        }
+    }
+    return h;
+}
+
+} // namespace
+
+double normalCDF(double x)
+{
+    return 0.5 * erfc(-x / sqrt(2.0));
+}
+
+double normalMass(double a, double b)
+{
+    if(b <= a) {
+        return 0.0;
+    }
+    // the difference of the two tails nearest to the interval
+    if(b <= 0.0) {
+        return normalCDF(b) - normalCDF(a);
+    } else if(a >= 0.0) {
+        return normalCDF(-a) - normalCDF(-b);
+    } else {
+        return 1.0 - normalCDF(a) - normalCDF(-b);
+    }
+}
+
+double normalQuantile(double p)
+{
+    if(p <= 0.0) {
+        return -HUGE_VAL;
+    } else if(p >= 1.0) {
+        return HUGE_VAL;
+    }
+
+    // Acklam's rational approximation, relative error below 1.2e-9
+    static const double a[6] = {-3.969683028665376e+01,  2.209460984245205e+02,
+                                -2.759285104469687e+02,  1.383577518672690e+02,
+                                -3.066479806614716e+01,  2.506628277459239e+00};
+    static const double b[5] = {-5.447609879822406e+01,  1.615858368580409e+02,
+                                -1.556989798598866e+02,  6.680131188771972e+01,
+                                -1.328068155288572e+01};
+    static const double c[6] = {-7.784894002430293e-03, -3.223964580411365e-01,
+                                -2.400758277161838e+00, -2.549732539343734e+00,
+                                 4.374664141464968e+00,  2.938163982698783e+00};
+    static const double d[4] = { 7.784695709041462e-03,  3.224671290700398e-01,
+                                 2.445134137142996e+00,  3.754408661907416e+00};
+    const double pLow = 0.02425;
+
+    double x;
+    if(p < pLow) {
+        double q = sqrt(-2.0 * log(p));
+        x = (((((c[0]*q + c[1])*q + c[2])*q + c[3])*q + c[4])*q + c[5]) /
+                ((((d[0]*q + d[1])*q + d[2])*q + d[3])*q + 1.0);
+    } else if(p <= 1.0 - pLow) {
+        double q = p - 0.5;
+        double r = q * q;
+        x = (((((a[0]*r + a[1])*r + a[2])*r + a[3])*r + a[4])*r + a[5])*q /
+                (((((b[0]*r + b[1])*r + b[2])*r + b[3])*r + b[4])*r + 1.0);
+    } else {
+        double q = sqrt(-2.0 * log1p(-p));
+        x = -(((((c[0]*q + c[1])*q + c[2])*q + c[3])*q + c[4])*q + c[5]) /
+                ((((d[0]*q + d[1])*q + d[2])*q + d[3])*q + 1.0);
+    }
+
+    // one Halley step refines it to full precision. The error is taken in
+    // the tail of x, where the cdf is accurate.
+    double e = (x <= 0.0) ? normalCDF(x) - p
+                          : (1.0 - p) - normalCDF(-x);
+    double u = e * sqrt(2.0 * PI) * exp(x * x / 2.0);
+    return x - u / (1.0 + x * u / 2.0);
+}
+
+double logBeta(double a, double b)
+{
+    return lgamma(a) + lgamma(b) - lgamma(a + b);
+}
+
+double incompleteBeta(double a, double b, double x)
+{
+    if(x <= 0.0) {
+        return 0.0;
+    } else if(x >= 1.0) {
+        return 1.0;
+    }
+    double front = exp(a * log(x) + b * log1p(-x) - logBeta(a, b));
+    // the continued fraction of the side where it converges
+    if(x < (a + 1.0) / (a + b + 2.0)) {
+        return front * betaContinuedFraction(a, b, x) / a;
+    } else {
+        return 1.0 - front * betaContinuedFraction(b, a, 1.0 - x) / b;
+    }
+}
+
+double incompleteBetaInverse(double a, double b, double p)
+{
+    if(p <= 0.0) {
+        return 0.0;
+    } else if(p >= 1.0) {
+        return 1.0;
+    }
+
+    // the initial guess
+    double x;
+    if((a >= 1.0) && (b >= 1.0)) {
+        // from the normal approximation
+        double z = normalQuantile(p);
+        double l = (z * z - 3.0) / 6.0;
+        double h = 2.0 / (1.0 / (2.0 * a - 1.0) + 1.0 / (2.0 * b - 1.0));
+        double w = z * sqrt(l + h) / h
+                - (1.0 / (2.0 * b - 1.0) - 1.0 / (2.0 * a - 1.0))
+                  * (l + 5.0 / 6.0 - 2.0 / (3.0 * h));
+        x = a / (a + b * exp(2.0 * w));
+    } else {
+        // from the power laws of the two tails
+        double ta = exp(a * log(a / (a + b))) / a;
+        double tb = exp(b * log(b / (a + b))) / b;
+        double w  = ta + tb;
+        if(p < ta / w) {
+            x = pow(a * w * p, 1.0 / a);
+        } else {
+            x = 1.0 - pow(b * w * (1.0 - p), 1.0 / b);
+        }
+    }
+
+    double lnB = logBeta(a, b);
+    for(int i = 0; i < 20; i++) {
+        if((x <= 0.0) || (x >= 1.0)) {
+            break;
+        }
+        double err = incompleteBeta(a, b, x) - p;
+        double pdf = exp((a - 1.0) * log(x) + (b - 1.0) * log1p(-x) - lnB);
+        double u   = err / pdf;
+        // Halley's correction, limited where the pdf curves sharply
+        double t   = u / (1.0 - 0.5 * std::min(1.0,
+                        u * ((a - 1.0) / x - (b - 1.0) / (1.0 - x))));
+        double next = x - t;
+        if(next <= 0.0) {
+            next = x / 2.0;
+        } else if(next >= 1.0) {
+            next = (x + 1.0) / 2.0;
+        }
+        x = next;
+        if(fabs(t) < Epsilon * x) {
+            break;
+        }
+    }
+    return std::min(std::max(x, 0.0), 1.0);
+}
+
+} // namespace Utils
+} // namespace CODeM
@@ -0,0 +1,49 @@
+/****************************************************************************
+**
+** The MIT License (MIT)
+**
+** Copyright (c) 2016 The University of Sheffield (www.sheffield.ac.uk)
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in all
+** copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE
+**
+****************************************************************************/
+#ifndef SPECIALFUNCTIONS_H
+#define SPECIALFUNCTIONS_H
+
+namespace CODeM {
+namespace Utils {
+
+// The standard normal cdf
+double normalCDF(double x);
+// The standard normal probability of [a,b], accurate in both tails
+double normalMass(double a, double b);
+// The inverse of normalCDF(), to full double precision
+double normalQuantile(double p);
+
+// log(B(a,b)), the logarithm of the beta function
+double logBeta(double a, double b);
+// The regularised incomplete beta function I_x(a,b)
+double incompleteBeta(double a, double b, double x);
+// The x for which I_x(a,b) = p, by Halley iterations on incompleteBeta()
+double incompleteBetaInverse(double a, double b, double p);
+
+} // namespace Utils
+} // namespace CODeM
+
+#endif // SPECIALFUNCTIONS_H
@@ -26,14 +26,18 @@
 #include <misc/CODeMMisc.h>
 #include <misc/examples/CODeMProblems.h>
 #include <core/CODeMGlobal.h>
+#include <core/utils/RandomStream.h>
+#include <core/RandomDistributions.h>
+#include <core/DistributionCache.h>
+#include <core/PeakQuantileSurface.h>
 
-#include <random>
 #include <ctime>
 #include <iostream>
 #include <stdio.h>
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 
 #include <libs/json/json.hpp>
 
@@ -41,8 +45,8 @@ using namespace std;
 using namespace CODeM;
 using json = nlohmann::json;
 
-inline void defineSeed(int seed) {std::srand(seed);}
-inline void randomSeed() {std::srand((unsigned)std::time(0));}
+inline void defineSeed(int seed) {Utils::defineRandomSeed(seed);}
+inline void randomSeed() {Utils::defineRandomSeed((unsigned)std::time(0));}
 
 void printVector(vector<double> vec, string sep=", ", string endVec="; ")
 {
@@ -111,7 +115,34 @@ void showUsage(char* progName)
 "                           negative value for NUMBER.                          \n"
 " -k, --nDirVars = NUMBER   The number of direction related variables for WFG   \n"
 "                           based problems. If NUMBER is not specified, the     \n"
-"                           default of nObj - 1 is used                         \n\n";
+"                           default of nObj - 1 is used                         \n\n"
+" -c, --cacheTol = NUMBER   Share the tables of distributions whose parameters  \n"
+"                           are within NUMBER of each other, by rounding the    \n"
+"                           parameters to multiples of NUMBER. If NUMBER is not \n"
+"                           specified, or is not positive, every distribution is\n"
+"                           computed exactly.                                   \n\n"
+" -a, --adaptiveTol = NUMBER                                                    \n"
+"                           Tabulate the distributions on adaptive grids, that  \n"
+"                           interpolate their pdf to within NUMBER relative to  \n"
+"                           its maximum, instead of equally spaced grids. If    \n"
+"                           NUMBER is not specified, or is not positive, the    \n"
+"                           grids are equally spaced.                           \n\n"
+" -b, --buildPeakSurface = FILENAME                                             \n"
+"                           Tabulate the quantiles of the peak distribution over\n"
+"                           a grid of tendency and locality values, write them  \n"
+"                           to FILENAME with the maximum interpolation error,   \n"
+"                           and exit.                                           \n\n"
+" -g, --surfaceGrid = GRID  The grid for --buildPeakSurface, within double      \n"
+"                           quotes: the number of tendency values, locality     \n"
+"                           values and probabilities, e.g., GRID = \"65 65 513\".\n"
+"                           A finer grid is more accurate and takes longer to   \n"
+"                           build and more memory to map. The default is        \n"
+"                           GRID = \"65 65 513\".                                 \n\n"
+" -q, --peakSurface = FILENAME                                                  \n"
+"                           Sample the peak distributions by interpolating the  \n"
+"                           quantile surface in FILENAME, written with          \n"
+"                           --buildPeakSurface, instead of computing their      \n"
+"                           tables.                                             \n\n";
 }
 
 int main(int argc, char** argv)
@@ -134,6 +165,12 @@ int main(int argc, char** argv)
     int nSamps = 5;
     int prob   = 0;
     int k      = 0;
+    double cacheTol = 0.0;
+    double adaptiveTol = 0.0;
+    string buildSurfaceFile;
+    string surfaceFile;
+    int surfaceGrid[3] = {PeakSurfaceNTendency, PeakSurfaceNLocality,
+                          PeakSurfaceNQuantiles};
 
 
     /// Parse command line inputs
@@ -268,6 +305,53 @@ int main(int argc, char** argv)
                 return EXIT_FAILURE;
             }
 
+        } else if ((arg == "-c") || (arg == "--cacheTol")) {
+            if (argInd < argc) {
+                cacheTol = atof(argv[argInd++]);
+            } else {
+                cerr << "--cacheTol option requires one argument." << endl;
+                return EXIT_FAILURE;
+            }
+
+        } else if ((arg == "-a") || (arg == "--adaptiveTol")) {
+            if (argInd < argc) {
+                adaptiveTol = atof(argv[argInd++]);
+            } else {
+                cerr << "--adaptiveTol option requires one argument." << endl;
+                return EXIT_FAILURE;
+            }
+
+        } else if ((arg == "-b") || (arg == "--buildPeakSurface")) {
+            if (argInd < argc) {
+                buildSurfaceFile = argv[argInd++];
+            } else {
+                cerr << "--buildPeakSurface option requires one argument." << endl;
+                return EXIT_FAILURE;
+            }
+
+        } else if ((arg == "-g") || (arg == "--surfaceGrid")) {
+            if (argInd < argc) {
+                istringstream iss(argv[argInd++]);
+                if(!(iss >> surfaceGrid[0] >> surfaceGrid[1] >> surfaceGrid[2])
+                        || (surfaceGrid[0] < 2) || (surfaceGrid[1] < 2)
+                        || (surfaceGrid[2] < 2)) {
+                    cerr << "Invalid argument for --surfaceGrid option: "
+                            "Requires three numbers larger than 1." << endl;
+                    return EXIT_FAILURE;
+                }
+            } else {
+                cerr << "--surfaceGrid option requires one argument." << endl;
+                return EXIT_FAILURE;
+            }
+
+        } else if ((arg == "-q") || (arg == "--peakSurface")) {
+            if (argInd < argc) {
+                surfaceFile = argv[argInd++];
+            } else {
+                cerr << "--peakSurface option requires one argument." << endl;
+                return EXIT_FAILURE;
+            }
+
         } else {
             cerr << "Unknown argument " << arg << endl;
             return EXIT_FAILURE;
@@ -285,6 +369,31 @@ int main(int argc, char** argv)
         k = nObj - 1;
     }
 
+    DistributionCache::instance().defineTolerance(cacheTol);
+    IDistribution::defineDefaultAdaptiveTolerance(adaptiveTol);
+
+    PeakQuantileSurface& surface = PeakQuantileSurface::instance();
+    if(!buildSurfaceFile.empty()) {
+        if(!PeakQuantileSurface::build(buildSurfaceFile, surfaceGrid[0],
+                                       surfaceGrid[1], surfaceGrid[2])
+                || !surface.load(buildSurfaceFile)) {
+            cerr << "Cannot write the peak quantile surface to "
+                 << buildSurfaceFile << endl;
+            return EXIT_FAILURE;
+        }
+        cout << "% Peak quantile surface:" << endl
+             << "surfaceGrid     = [" << surface.nTendency()  << " "
+                                      << surface.nLocality()  << " "
+                                      << surface.nQuantiles() << "];" << endl
+             << "surfaceMaxError = "  << surface.maxError()   << ";" << endl;
+        return EXIT_SUCCESS;
+    }
+    if(!surfaceFile.empty() && !surface.load(surfaceFile)) {
+        cerr << "Cannot load the peak quantile surface " << surfaceFile
+             << endl;
+        return EXIT_FAILURE;
+    }
+
 
     /// Print run configuration settings
     cout << "% CODeM Toolkit Demosntrator v1.0\n"
@@ -395,6 +504,54 @@ int main(int argc, char** argv)
         jsonOutput["rndObjSamps"] = oVecSamps;
     }
 
+    if(DistributionCache::instance().isEnabled()) {
+        DistributionCache& cache = DistributionCache::instance();
+        cout << "\n% Distribution cache:" << endl
+             << "cacheTol    = " << cache.tolerance() << ";" << endl
+             << "cacheHits   = " << cache.hits()      << ";" << endl
+             << "cacheMisses = " << cache.misses()    << ";" << endl;
+        if (writeJsonFile){
+            json jsonAux;
+            jsonAux["cacheTol"]    = cache.tolerance();
+            jsonAux["cacheHits"]   = cache.hits();
+            jsonAux["cacheMisses"] = cache.misses();
+            jsonOutput["distributionCache"] = jsonAux;
+        }
+    }
+
+    if(IDistribution::defaultAdaptiveTolerance() > 0.0) {
+        cout << "\n% Adaptive grids:" << endl
+             << "adaptiveTol       = " << IDistribution::defaultAdaptiveTolerance()
+             << ";" << endl
+             << "gridPoints        = " << IDistribution::gridPoints()
+             << ";" << endl
+             << "uniformGridPoints = " << IDistribution::uniformGridPoints()
+             << ";" << endl;
+        if (writeJsonFile){
+            json jsonAux;
+            jsonAux["adaptiveTol"]       = IDistribution::defaultAdaptiveTolerance();
+            jsonAux["gridPoints"]        = IDistribution::gridPoints();
+            jsonAux["uniformGridPoints"] = IDistribution::uniformGridPoints();
+            jsonOutput["adaptiveGrids"] = jsonAux;
+        }
+    }
+
+    if(surface.isLoaded()) {
+        cout << "\n% Peak quantile surface:" << endl
+             << "surfaceGrid     = [" << surface.nTendency()  << " "
+                                      << surface.nLocality()  << " "
+                                      << surface.nQuantiles() << "];" << endl
+             << "surfaceMaxError = "  << surface.maxError()   << ";" << endl;
+        if (writeJsonFile){
+            json jsonAux;
+            jsonAux["surfaceGrid"]     = {surface.nTendency(),
+                                          surface.nLocality(),
+                                          surface.nQuantiles()};
+            jsonAux["surfaceMaxError"] = surface.maxError();
+            jsonOutput["peakSurface"] = jsonAux;
+        }
+    }
+
     if (writeJsonFile){
     
         std::ofstream ofs(argv[jsonFileIndex], std::ofstream::out);
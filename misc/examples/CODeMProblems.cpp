@@ -27,80 +27,286 @@
 #include <core/UncertaintyKernel.h>
 #include <core/CODeMOperators.h>
 #include <core/CODeMDistribution.h>
-#include <core/RandomDistributions.h>
+#include <core/DistributionEngine.h>
 #include <core/utils/ScalingUtils.h>
 
 #include <libs/WFG/ExampleProblems.h>
 #include <libs/DTLZ/DTLZProblems.h>
 
+#include <algorithm>
+
 using std::vector;
 using namespace WFGT::Toolkit::Examples::Problems;
 using namespace CODeM::Utils;
 
 namespace CODeM {
 
-vector<double> CODeM1(const vector<double> &iVec, int k, int nObj)
+// Solution streams of the optimal and random sets are kept apart by the upper
+// 32 bits of the solution index. The decision vectors are drawn from a
+// substream that is not used by the samples.
+const uint64_t OptimalSetStreams(uint64_t(0) << 32);
+const uint64_t RandomSetStreams(uint64_t(1) << 32);
+const uint32_t DecisionSubstream(0xFFFFFFFEu);
+
+namespace {
+
+// The settings of the uncertainty kernel of a problem. The directed objective
+// boundaries of problems 0 and 6 depend on the solution, see solutionBounds().
+struct KernelSettings
 {
-    // Evaluate the decision vector
-    vector<double> oVec = WFG4(iVec, k, nObj);
+    vector<double> ideal;
+    vector<double> antiIdeal;
+    double         lb;
+    double         ub;
+    double         distanceNorm;
+    // The largest objective value of problems 0 and 6, zero for the others
+    double         maxVal;
+};
+
+// The properties of the uncertainty kernels of n solutions, a column each
+struct KernelColumns
+{
+    int           n;
+    const double* proximity;
+    const double* symmetry;
+    const double* oComponent0;
+};
 
-    return CODeM1Perturb(oVec)[0];
+KernelSettings kernelSettings(int problem, size_t nVars, size_t nObj)
+{
+    KernelSettings s;
+    s.ideal.assign(nObj, 0.0);
+    s.antiIdeal.resize(nObj);
+    switch(problem)
+    {
+    case 1: case 2: case 3: case 4:
+    {
+        for(size_t j = 0; j < nObj; ++j) {
+            s.antiIdeal[j] = 3.0*(j+1);
+        }
+        s.lb           = 2.0/3.0;
+        s.ub           = 1.0;
+        s.distanceNorm = 2.0;
+        s.maxVal       = 0.0;
+        break;
+    }
+    case 0: case 6: default:
+    {
+        // DTLZ1 is modified so the 100 scale of the distance function
+        // is not included
+        s.maxVal = (problem == 6) ? 1.125 * nVars
+                                  : 1.125 * (nVars - nObj + 1) + 0.5;
+        std::fill(s.antiIdeal.begin(), s.antiIdeal.end(), s.maxVal);
+        s.lb           = 0.0;
+        s.ub           = 1.0;
+        s.distanceNorm = 1.0;
+        break;
+    }
+    }
+    return s;
 }
 
-vector<vector<double> > CODeM1(const vector<double> &iVec,
-                                int k, int nObj, int nSamp)
+// The directed objective boundaries of the solution with the deterministic
+// objective vector oVec
+void solutionBounds(const KernelSettings& s, const vector<double>& oVec,
+                    double& lb, double& ub)
 {
-    // Evaluate the decision vector
-    vector<double> oVec = WFG4(iVec, k, nObj);
-
-    return CODeM1Perturb(oVec, nSamp);
+    if(s.maxVal <= 0.0) {
+        lb = s.lb;
+        ub = s.ub;
+        return;
+    }
+    vector<double> normVec(oVec);
+    toUnitVec(normVec, 2.0);
+    double sFactor = magnitudeP(normVec, 1);
+    ub = 1.0 / sFactor;
+    lb = 0.5 / s.maxVal / sFactor;
 }
 
-vector<vector<double> > CODeM1Perturb(const vector<double> &oVec, int nSamp)
+// The CODeM distributions and the directional perturbation radii of the
+// solutions, from the properties of their uncertainty kernels
+void uncertaintyParameters(int problem, const KernelColumns& k,
+                           DistributionEngine* d, double* dirPertRad)
 {
-    // Set the uncertainty kernel
-    vector<double> ideal(oVec.size(), 0);
-    vector<double> antiIdeal(oVec.size());
-    for(int i=0; i<oVec.size(); i++) {
-        antiIdeal[i] = 3*(i+1);
+    int n = k.n;
+    const double* proximity = k.proximity;
+    const double* symmetry  = k.symmetry;
+
+    // The parameters of the distributions, a column each
+    vector<double> param0(n);
+    vector<double> param1(n);
+    switch(problem)
+    {
+    case 1:
+    {
+        // peak tendency and locality
+        std::copy(proximity, proximity + n, param0.begin());
+        lowOnValue(proximity, n, 0.0, 0.05, param1.data());
+        std::fill(dirPertRad, dirPertRad + n, 0.0);
+        break;
+    }
+    case 2:
+    {
+        // uniform bounds
+        std::copy(proximity, proximity + n, param0.begin());
+        std::copy(proximity, proximity + n, param1.begin());
+        for(int i = 0; i < n; ++i) {
+            dirPertRad[i] = 0.1 * symmetry[i];
+        }
+        break;
+    }
+    case 3:
+    {
+        // uniform bounds; the peak tendency and locality are the
+        // proximity and the symmetry
+        skewedDecrease(proximity, n, 1.5, param1.data());
+        lowOnValue(k.oComponent0, n, 0.45, 0.3, dirPertRad);
+        for(int i = 0; i < n; ++i) {
+            param0[i]     = proximity[i];
+            param1[i]     = param0[i] + (1-param1[i]) * (1.0-param0[i]);
+            dirPertRad[i] = 0.04*dirPertRad[i];
+        }
+        break;
+    }
+    case 4:
+    {
+        // peak tendency and locality
+        linearDecrease(symmetry, n, dirPertRad);
+        for(int i = 0; i < n; ++i) {
+            param0[i]     = proximity[i]+0.1;
+            param1[i]     = 0.8;
+            dirPertRad[i] = 0.2*dirPertRad[i]+0.01;
+        }
+        break;
+    }
+    case 6:
+    {
+        // uniform bounds
+        for(int i = 0; i < n; ++i) {
+            param1[i] = proximity[i]*symmetry[i];
+        }
+        linearDecrease(param1.data(), n, param1.data());
+        for(int i = 0; i < n; ++i) {
+            param0[i]     = proximity[i];
+            param1[i]     = param0[i] + (1.0-param1[i]) * (1.0-param0[i]);
+            dirPertRad[i] = 0.2 * k.oComponent0[i];
+        }
+        break;
+    }
+    case 0: default:
+    {
+        // uniform bounds
+        lowOnValue(proximity, n, 0.0, 1.0, param1.data());
+        linearDecrease(symmetry, n, dirPertRad);
+        for(int i = 0; i < n; ++i) {
+            param0[i]     = proximity[i];
+            param1[i]     = 1.0 -  (0.9 + 0.1 * param1[i]) * (1.0-param0[i]);
+            dirPertRad[i] = 0.02 + 0.1 * dirPertRad[i];
+        }
+        break;
+    }
     }
-    double lb = 2.0/3.0;
-    double ub = 1.0;
 
-    UncertaintyKernel uk(oVec, lb, ub, ideal, antiIdeal);
+    for(int i = 0; i < n; ++i) {
+        switch(problem)
+        {
+        case 1: case 4:
+            d[i] = DistributionEngine::peak(param0[i], param1[i]);
+            break;
+        case 3:
+            d[i] = DistributionEngine();
+            d[i].appendComponent(DistributionEngine::uniform(param0[i],
+                                                             param1[i]), 0.5);
+            d[i].appendComponent(DistributionEngine::peak(proximity[i],
+                                                          symmetry[i]), 0.5);
+            break;
+        default:
+            d[i] = DistributionEngine::uniform(param0[i], param1[i]);
+            break;
+        }
+    }
+}
 
-    // Evaluate the uncertainty parameters
-    double peakTend, peakLoc, dirPertRad;
+// Samples the CODeM distribution of the solution of the problem with the
+// deterministic objective vector oVec and nVars decision variables
+vector<vector<double> > perturbSolution(int problem, size_t nVars,
+                                        const vector<double> &oVec, int nSamp,
+                                        const RandomStream &rs)
+{
+    KernelSettings s = kernelSettings(problem, nVars, oVec.size());
+    double lb, ub;
+    solutionBounds(s, oVec, lb, ub);
+
+    UncertaintyKernel uk(oVec, lb, ub, s.ideal, s.antiIdeal);
+    double proximity   = uk.proximity();
+    double symmetry    = uk.symmetry();
+    double oComponent0 = uk.oComponent(0);
+    KernelColumns k = {1, &proximity, &symmetry, &oComponent0};
+
+    DistributionEngine d;
+    double dirPertRad;
+    uncertaintyParameters(problem, k, &d, &dirPertRad);
+
+    CODeMDistribution cd(d, oVec, lb, ub, s.ideal, s.antiIdeal, dirPertRad,
+                         s.distanceNorm);
+    return cd.sampleDistribution(0, nSamp, rs);
+}
 
-    peakTend = uk.proximity();
-    peakLoc  = lowOnValue(uk.proximity(), 0.0, 0.05);
+// Samples the CODeM distributions of the solutions with the deterministic
+// objective vectors oVecDeterm, the same as perturbSolution() does for each
+// of them with the stream of solution streams + i. The uncertainty kernel is
+// evaluated for the whole population at once.
+void perturbPopulation(int problem, size_t nVars,
+                       const vector<vector<double> >          &oVecDeterm,
+                       vector<vector<vector<double> > >       &oVecSamps,
+                       uint64_t streams)
+{
+    int nSols  = (int)oVecDeterm.size();
+    int nObj   = (int)oVecDeterm[0].size();
+    int nSamps = (int)oVecSamps[0].size();
 
-    double distanceNorm = 2.0;
+    vector<double> objectives((size_t)nSols * nObj);
+    for(int i = 0; i < nSols; ++i) {
+        std::copy(oVecDeterm[i].begin(), oVecDeterm[i].end(),
+                  objectives.begin() + (size_t)i * nObj);
+    }
 
-    dirPertRad = 0.0;
+    KernelSettings s = kernelSettings(problem, nVars, nObj);
+    vector<double> lb(nSols);
+    vector<double> ub(nSols);
+    for(int i = 0; i < nSols; ++i) {
+        solutionBounds(s, oVecDeterm[i], lb[i], ub[i]);
+    }
 
-    // Create the CODeM distribution
-    PeakDistribution* d = new PeakDistribution(peakTend, peakLoc);
+    UncertaintyKernelBatch uk(objectives.data(), nSols, nObj, lb.data(),
+                              ub.data(), s.ideal, s.antiIdeal);
+    KernelColumns k = {nSols, uk.proximity().data(), uk.symmetry().data(),
+                       uk.oComponent(0)};
 
-    CODeMDistribution cd(d, oVec, lb, ub, ideal, antiIdeal, dirPertRad, distanceNorm);
+    vector<DistributionEngine> d(nSols);
+    vector<double> dirPertRad(nSols);
+    uncertaintyParameters(problem, k, d.data(), dirPertRad.data());
 
-    // Sample the distribution
-    vector<vector<double> > samples;
-    for(int i=0; i<nSamp; i++) {
-        samples.push_back(cd.sampleDistribution());
+    // Sample the CODeM distributions
+    for(int i = 0; i < nSols; ++i) {
+        CODeMDistribution cd(d[i], oVecDeterm[i], lb[i], ub[i], s.ideal,
+                             s.antiIdeal, dirPertRad[i], s.distanceNorm);
+        RandomStream rs(randomSeed(), streams + i);
+        oVecSamps[i] = cd.sampleDistribution(0, nSamps, rs);
     }
-    return samples;
 }
 
-vector<double> RCP1(const vector<double> &iVec, int k, int nObj)
+} // namespace
+
+vector<double> CODeM1(const vector<double> &iVec, int k, int nObj)
 {
     // Evaluate the decision vector
-    vector<double> oVec = WFG4Tunable(iVec, k, nObj, 5, 10.0);
+    vector<double> oVec = WFG4(iVec, k, nObj);
 
     return CODeM1Perturb(oVec)[0];
 }
 
-vector<vector<double> > RCP1(const vector<double> &iVec,
+vector<vector<double> > CODeM1(const vector<double> &iVec,
                                 int k, int nObj, int nSamp)
 {
     // Evaluate the decision vector
@@ -109,40 +315,43 @@ vector<vector<double> > RCP1(const vector<double> &iVec,
     return CODeM1Perturb(oVec, nSamp);
 }
 
-vector<vector<double> > RCP1Perturb(const vector<double> &oVec, int nSamp)
+vector<vector<double> > CODeM1Perturb(const vector<double> &oVec, int nSamp)
 {
-    // Set the uncertainty kernel
-    vector<double> ideal(oVec.size(), 0);
-    vector<double> antiIdeal(oVec.size());
-    for(int i=0; i<oVec.size(); i++) {
-        antiIdeal[i] = 3*(i+1);
-    }
-    double lb = 2.0/3.0;
-    double ub = 1.0;
-
-    UncertaintyKernel uk(oVec, lb, ub, ideal, antiIdeal);
+    return CODeM1Perturb(oVec, nSamp, nextRandomStream());
+}
 
-    // Evaluate the uncertainty parameters
-    double peakTend, peakLoc, dirPertRad;
+vector<vector<double> > CODeM1Perturb(const vector<double> &oVec, int nSamp,
+                                      const RandomStream &rs)
+{
+    return perturbSolution(1, 0, oVec, nSamp, rs);
+}
 
-    peakTend = uk.proximity();
-    peakLoc  = lowOnValue(uk.proximity(), 0.0, 0.05);
+vector<double> RCP1(const vector<double> &iVec, int k, int nObj)
+{
+    // Evaluate the decision vector
+    vector<double> oVec = WFG4Tunable(iVec, k, nObj, 5, 10.0);
 
-    double distanceNorm = 2.0;
+    return CODeM1Perturb(oVec)[0];
+}
 
-    dirPertRad = 0.0;
+vector<vector<double> > RCP1(const vector<double> &iVec,
+                                int k, int nObj, int nSamp)
+{
+    // Evaluate the decision vector
+    vector<double> oVec = WFG4(iVec, k, nObj);
 
-    // Create the CODeM distribution
-    PeakDistribution* d = new PeakDistribution(peakTend, peakLoc);
+    return CODeM1Perturb(oVec, nSamp);
+}
 
-    CODeMDistribution cd(d, oVec, lb, ub, ideal, antiIdeal, dirPertRad, distanceNorm);
+vector<vector<double> > RCP1Perturb(const vector<double> &oVec, int nSamp)
+{
+    return RCP1Perturb(oVec, nSamp, nextRandomStream());
+}
 
-    // Sample the distribution
-    vector<vector<double> > samples;
-    for(int i=0; i<nSamp; i++) {
-        samples.push_back(cd.sampleDistribution());
-    }
-    return samples;
+vector<vector<double> > RCP1Perturb(const vector<double> &oVec, int nSamp,
+                                    const RandomStream &rs)
+{
+    return perturbSolution(1, 0, oVec, nSamp, rs);
 }
 
 vector<double> CODeM2(const vector<double> &iVec, int k, int nObj)
@@ -163,38 +372,13 @@ vector<vector<double> > CODeM2(const vector<double> &iVec, int k, int nObj, int
 
 vector<vector<double> > CODeM2Perturb(const vector<double> &oVec, int nSamp)
 {
-    // Set the uncertainty kernel
-    vector<double> ideal(oVec.size(), 0.0);
-    vector<double> antiIdeal(oVec.size());
-    for(int i=0; i<oVec.size(); i++) {
-        antiIdeal[i] = 3.0*(i+1);
-    }
-    double lb = 2.0/3.0;
-    double ub = 1.0;
-
-    UncertaintyKernel uk(oVec, lb, ub, ideal, antiIdeal);
-
-    // Evaluate the uncertainty parameters
-    double uniLB, uniUB, dirPertRad;
-
-    uniLB  = uk.proximity();
-    uniUB  = uniLB;
-
-    double distanceNorm = 2.0;
-
-    dirPertRad = 0.1 * uk.symmetry();
-
-    // Create the CODeM distribution
-    UniformDistribution* d =new UniformDistribution(uniLB, uniUB);
-
-    CODeMDistribution cd(d, oVec, lb, ub, ideal, antiIdeal, dirPertRad, distanceNorm);
+    return CODeM2Perturb(oVec, nSamp, nextRandomStream());
+}
 
-    // Sample the distribution
-    vector<vector<double> > samples;
-    for(int i=0; i<nSamp; i++) {
-        samples.push_back(cd.sampleDistribution());
-    }
-    return samples;
+vector<vector<double> > CODeM2Perturb(const vector<double> &oVec, int nSamp,
+                                      const RandomStream &rs)
+{
+    return perturbSolution(2, 0, oVec, nSamp, rs);
 }
 
 vector<double> CODeM3(const vector<double> &iVec, int k, int nObj)
@@ -215,45 +399,13 @@ vector<vector<double> > CODeM3(const vector<double> &iVec, int k, int nObj, int
 
 vector<vector<double> > CODeM3Perturb(const vector<double> &oVec, int nSamp)
 {
-    // Set the uncertainty kernel
-    vector<double> ideal(oVec.size(), 0);
-    vector<double> antiIdeal(oVec.size());
-    for(int i=0; i<oVec.size(); i++) {
-        antiIdeal[i] = 3.0*(i+1);
-    }
-    double lb = 2.0/3.0;
-    double ub = 1.0;
-
-
-    UncertaintyKernel uk(oVec, lb, ub, ideal, antiIdeal);
-
-    // Evaluate the uncertainty parameters
-    double uniLB, uniLoc, uniUB, peakTend, peakLoc, dirPertRad;
-
-    uniLB  = uk.proximity();
-    uniLoc = skewedDecrease(uk.proximity(), 1.5);
-    uniUB  = uniLB + (1-uniLoc) * (1.0-uniLB);
-
-    peakTend = uk.proximity();
-    peakLoc  = uk.symmetry();
-
-    double distanceNorm = 2.0;
-
-    dirPertRad = 0.04*lowOnValue(uk.oComponent(0), 0.45, 0.3);
-
-    // Create the CODeM distribution
-    MergedDistribution* d = new MergedDistribution;
-    d->appendDistribution(new UniformDistribution(uniLB, uniUB), 0.5);
-    d->appendDistribution(new PeakDistribution(peakTend, peakLoc), 0.5);
-
-    CODeMDistribution cd(d, oVec, lb, ub, ideal, antiIdeal, dirPertRad, distanceNorm);
+    return CODeM3Perturb(oVec, nSamp, nextRandomStream());
+}
 
-    // Sample the distribution
-    vector<vector<double> > samples;
-    for(int i=0; i<nSamp; i++) {
-        samples.push_back(cd.sampleDistribution());
-    }
-    return samples;
+vector<vector<double> > CODeM3Perturb(const vector<double> &oVec, int nSamp,
+                                      const RandomStream &rs)
+{
+    return perturbSolution(3, 0, oVec, nSamp, rs);
 }
 
 vector<double> CODeM4(const vector<double> &iVec, int k, int nObj)
@@ -274,38 +426,13 @@ vector<vector<double> > CODeM4(const vector<double> &iVec, int k, int nObj, int
 
 vector<vector<double> > CODeM4Perturb(const vector<double> &oVec, int nSamp)
 {
-    // Set the uncertainty kernel
-    vector<double> ideal(oVec.size(), 0.0);
-    vector<double> antiIdeal(oVec.size());
-    for(int i=0; i<oVec.size(); i++) {
-        antiIdeal[i] = 3.0*(i+1);
-    }
-    double lb = 2.0/3.0;
-    double ub = 1.0;
-
-    UncertaintyKernel uk(oVec, lb, ub, ideal, antiIdeal);
-
-    // Evaluate the uncertainty parameters
-    double peakTend, peakLoc, dirPertRad;
-
-    peakTend = uk.proximity()+0.1;
-    peakLoc  = 0.8;
-
-    double distanceNorm = 2.0;
-
-    dirPertRad = 0.2*linearDecrease(uk.symmetry())+0.01;
-
-    // Create the CODeM distribution
-    PeakDistribution* d = new PeakDistribution(peakTend, peakLoc);
-
-    CODeMDistribution cd(d, oVec, lb, ub, ideal, antiIdeal, dirPertRad, distanceNorm);
+    return CODeM4Perturb(oVec, nSamp, nextRandomStream());
+}
 
-    // Sample the distribution
-    vector<vector<double> > samples;
-    for(int i=0; i<nSamp; i++) {
-        samples.push_back(cd.sampleDistribution());
-    }
-    return samples;
+vector<vector<double> > CODeM4Perturb(const vector<double> &oVec, int nSamp,
+                                      const RandomStream &rs)
+{
+    return perturbSolution(4, 0, oVec, nSamp, rs);
 }
 
 vector<double> CODeM5(const vector<double> &iVec, int k, int nObj)
@@ -326,6 +453,13 @@ vector<vector<double> > CODeM5(const vector<double> &iVec, int k, int nObj, int
 
 vector<vector<double> > CODeM5Perturb(const vector<double> &iVec,
                                       const vector<double> &oVec, int nSamp)
+{
+    return CODeM5Perturb(iVec, oVec, nSamp, nextRandomStream());
+}
+
+vector<vector<double> > CODeM5Perturb(const vector<double> &iVec,
+                                      const vector<double> &oVec, int nSamp,
+                                      const RandomStream &rs)
 {
     // Set the uncertainty kernel
     vector<double> ideal(oVec.size(), 0.0);
@@ -355,16 +489,12 @@ vector<vector<double> > CODeM5Perturb(const vector<double> &iVec,
     dirPertRad = 0.1 * uk.dComponent(0);
 
     // Create the CODeM distribution
-    UniformDistribution* d =new UniformDistribution(uniLB, uniUB);
+    DistributionEngine d = DistributionEngine::uniform(uniLB, uniUB);
 
     CODeMDistribution cd(d, oVec, lb, ub, ideal, antiIdeal, dirPertRad, distanceNorm);
 
     // Sample the distribution
-    vector<vector<double> > samples;
-    for(int i=0; i<nSamp; i++) {
-        samples.push_back(cd.sampleDistribution());
-    }
-    return samples;
+    return cd.sampleDistribution(0, nSamp, rs);
 }
 
 vector<double> CODeM6(const vector<double> &iVec, int nObj)
@@ -391,47 +521,22 @@ vector<vector<double> > CODeM6Perturb(const vector<double> &iVec,
     return CODeM6Perturb(iVec.size(), oVec, nSamp);
 }
 
-vector<vector<double> > CODeM6Perturb(size_t iVecSize, const vector<double> &oVec, int nSamp)
+vector<vector<double> > CODeM6Perturb(const vector<double> &iVec,
+                                      const vector<double> &oVec,
+                                      int nSamp, const RandomStream &rs)
 {
-    // Set the uncertainty kernel
-    vector<double> ideal(oVec.size(), 0.0);
-
-    // DTLZ1 is modified so the 100 scale of the distance function
-    // is not included
-    double maxVal = 1.125 * iVecSize;
-    vector<double> antiIdeal(oVec.size(), maxVal);
-
-    vector<double> normVec(oVec);
-    toUnitVec(normVec, 2.0);
-    double sFactor = magnitudeP(normVec, 1);
-
-    double ub = 1.0 / sFactor;
-    double lb = 0.5 / maxVal / sFactor;
-
-    UncertaintyKernel uk(oVec, lb, ub, ideal, antiIdeal);
-
-    // Evaluate the uncertainty parameters
-    double uniLB, uniUB, uniLoc, dirPertRad;
-
-    uniLB  = uk.proximity();
-    uniLoc = linearDecrease(uk.proximity()*uk.symmetry());
-    uniUB  = uniLB + (1.0-uniLoc) * (1.0-uniLB);
-
-    double distanceNorm = 1.0;
-
-    dirPertRad = 0.2 * uk.oComponent(0);
-
-    // Create the CODeM distribution
-    UniformDistribution* d = new UniformDistribution(uniLB, uniUB);
+    return CODeM6Perturb(iVec.size(), oVec, nSamp, rs);
+}
 
-    CODeMDistribution cd(d, oVec, lb, ub, ideal, antiIdeal, dirPertRad, distanceNorm);
+vector<vector<double> > CODeM6Perturb(size_t iVecSize, const vector<double> &oVec, int nSamp)
+{
+    return CODeM6Perturb(iVecSize, oVec, nSamp, nextRandomStream());
+}
 
-    // Sample the distribution
-    vector<vector<double> > samples;
-    for(int i=0; i<nSamp; i++) {
-        samples.push_back(cd.sampleDistribution());
-    }
-    return samples;
+vector<vector<double> > CODeM6Perturb(size_t iVecSize, const vector<double> &oVec,
+                                      int nSamp, const RandomStream &rs)
+{
+    return perturbSolution(6, iVecSize, oVec, nSamp, rs);
 }
 
 vector<double> GECCOExample(const vector<double> &iVec, int nObj)
@@ -453,43 +558,13 @@ vector<vector<double> > GECCOExample(const vector<double> &iVec, int nObj, int n
 vector<vector<double> > GECCOExamplePerturb(size_t iVecSize, const vector<double> &oVec,
                                             int nSamp)
 {
-    // Set the uncertainty kernel
-    vector<double> ideal(oVec.size(), 0.0);
-
-    double maxVal = 1.125 * (iVecSize - oVec.size() + 1) + 0.5;
-    vector<double> antiIdeal(oVec.size(), maxVal);
-
-    vector<double> normVec(oVec);
-    toUnitVec(normVec, 2.0);
-    double sFactor = magnitudeP(normVec, 1);
-
-    double ub = 1.0 / sFactor;
-    double lb = 0.5 / maxVal / sFactor;
-
-    UncertaintyKernel uk(oVec, lb, ub, ideal, antiIdeal);
-
-    // Evaluate the uncertainty parameters
-    double uniLB, uniUB, uniLoc, dirPertRad;
-
-    uniLB  = uk.proximity();
-    uniLoc = 0.9 + 0.1 * lowOnValue(uk.proximity(), 0.0, 1.0);
-    uniUB  = 1.0 -  uniLoc * (1.0-uniLB);
-
-    double distanceNorm = 1.0;
-
-    dirPertRad = 0.02 + 0.1 * linearDecrease(uk.symmetry());
-
-    // Create the CODeM distribution
-    UniformDistribution* d = new UniformDistribution(uniLB, uniUB);
-
-    CODeMDistribution cd(d, oVec, lb, ub, ideal, antiIdeal, dirPertRad, distanceNorm);
+    return GECCOExamplePerturb(iVecSize, oVec, nSamp, nextRandomStream());
+}
 
-    // Sample the distribution
-    vector<vector<double> > samples;
-    for(int i=0; i<nSamp; i++) {
-        samples.push_back(cd.sampleDistribution());
-    }
-    return samples;
+vector<vector<double> > GECCOExamplePerturb(size_t iVecSize, const vector<double> &oVec,
+                                            int nSamp, const RandomStream &rs)
+{
+    return perturbSolution(0, iVecSize, oVec, nSamp, rs);
 }
 
 vector<vector<double> > GECCOExamplePerturb(const vector<double> &iVec,
@@ -498,6 +573,13 @@ vector<vector<double> > GECCOExamplePerturb(const vector<double> &iVec,
     return GECCOExamplePerturb(iVec.size(), oVec, nSamp);
 }
 
+vector<vector<double> > GECCOExamplePerturb(const vector<double> &iVec,
+                                            const vector<double> &oVec,
+                                            int nSamp, const RandomStream &rs)
+{
+    return GECCOExamplePerturb(iVec.size(), oVec, nSamp, rs);
+}
+
 
 vector<double> deterministicOVec(int prob, const vector<double> &iVec, int nObj, int k)
 {
@@ -596,7 +678,6 @@ void optimalSet(vector<vector<double> >          &dVectors,
     int nSols   = dVectors.size();
     int nVars   = dVectors[0].size();
     int nObj    = oVecDeterm[0].size();
-    int nSamps  = oVecSamps[0].size();
 
     // create optimal decision vectors with random direction variables
     switch(problem)
@@ -604,8 +685,9 @@ void optimalSet(vector<vector<double> >          &dVectors,
     case 1: case 2: case 3: case 4:
     {
         for(int i = 0; i < nSols; ++i) {
+            RandomStream rs(randomSeed(), OptimalSetStreams + i, DecisionSubstream);
             for(int j = 0; j < k; ++j) {
-                dVectors[i][j] = randUni() * 2.0 * (j + 1);
+                dVectors[i][j] = rs.uniform() * 2.0 * (j + 1);
             }
             for(int j = k; j < nVars; ++j) {
                 dVectors[i][j] = 0.35 * 2.0 * (j + 1);
@@ -617,8 +699,9 @@ void optimalSet(vector<vector<double> >          &dVectors,
     {
         k = nObj - 1;
         for(int i = 0; i < nSols; ++i) {
+            RandomStream rs(randomSeed(), OptimalSetStreams + i, DecisionSubstream);
             for(int j = 0; j < k; ++j) {
-                dVectors[i][j] = randUni();
+                dVectors[i][j] = rs.uniform();
             }
             for(int j = k; j < nVars; ++j) {
                 dVectors[i][j] = 0.5;
@@ -631,40 +714,8 @@ void optimalSet(vector<vector<double> >          &dVectors,
     // Evaluate the vectors
     for(int i = 0; i < nSols; ++i) {
         oVecDeterm[i] = deterministicOVec(problem, dVectors[i], nObj, k);
-        switch(problem)
-        {
-        case 0: default:
-        {
-            oVecSamps[i] = GECCOExamplePerturb(nVars, oVecDeterm[i], nSamps);
-            break;
-        }
-        case 1:
-        {
-            oVecSamps[i] = CODeM1Perturb(oVecDeterm[i], nSamps);
-            break;
-        }
-        case 2:
-        {
-            oVecSamps[i] =  CODeM2Perturb(oVecDeterm[i], nSamps);
-            break;
-        }
-        case 3:
-        {
-            oVecSamps[i] =  CODeM3Perturb(oVecDeterm[i], nSamps);
-            break;
-        }
-        case 4:
-        {
-            oVecSamps[i] =  CODeM4Perturb(oVecDeterm[i], nSamps);
-            break;
-        }
-        case 6:
-        {
-            oVecSamps[i] =  CODeM6Perturb(nVars, oVecDeterm[i], nSamps);
-            break;
-        }
-        }
     }
+    perturbPopulation(problem, nVars, oVecDeterm, oVecSamps, OptimalSetStreams);
 }
 
 void randomSet(vector<vector<double> >          &dVectors,
@@ -679,7 +730,6 @@ void randomSet(vector<vector<double> >          &dVectors,
     int nSols   = dVectors.size();
     int nVars   = dVectors[0].size();
     int nObj    = oVecDeterm[0].size();
-    int nSamps  = oVecSamps[0].size();
 
     // create random decision vectors
     switch(problem)
@@ -687,8 +737,9 @@ void randomSet(vector<vector<double> >          &dVectors,
     case 1: case 2: case 3: case 4:
     {
         for(int i = 0; i < nSols; ++i) {
+            RandomStream rs(randomSeed(), RandomSetStreams + i, DecisionSubstream);
             for(int j = 0; j < nVars; ++j) {
-                dVectors[i][j] = randUni() * 2.0 * (j + 1);
+                dVectors[i][j] = rs.uniform() * 2.0 * (j + 1);
             }
         }
         break;
@@ -697,8 +748,9 @@ void randomSet(vector<vector<double> >          &dVectors,
     {
         k = nObj - 1;
         for(int i = 0; i < nSols; ++i) {
+            RandomStream rs(randomSeed(), RandomSetStreams + i, DecisionSubstream);
             for(int j = 0; j < nVars; ++j) {
-                dVectors[i][j] = randUni();
+                dVectors[i][j] = rs.uniform();
             }
         }
         break;
@@ -708,40 +760,8 @@ void randomSet(vector<vector<double> >          &dVectors,
     // Evaluate the vectors
     for(int i = 0; i < nSols; ++i) {
         oVecDeterm[i] = deterministicOVec(problem, dVectors[i], nObj, k);
-        switch(problem)
-        {
-        case 0: default:
-        {
-            oVecSamps[i] = GECCOExamplePerturb(nVars, oVecDeterm[i], nSamps);
-            break;
-        }
-        case 1:
-        {
-            oVecSamps[i] = CODeM1Perturb(oVecDeterm[i], nSamps);
-            break;
-        }
-        case 2:
-        {
-            oVecSamps[i] =  CODeM2Perturb(oVecDeterm[i], nSamps);
-            break;
-        }
-        case 3:
-        {
-            oVecSamps[i] =  CODeM3Perturb(oVecDeterm[i], nSamps);
-            break;
-        }
-        case 4:
-        {
-            oVecSamps[i] =  CODeM4Perturb(oVecDeterm[i], nSamps);
-            break;
-        }
-        case 6:
-        {
-            oVecSamps[i] =  CODeM6Perturb(nVars, oVecDeterm[i], nSamps);
-            break;
-        }
-        }
     }
+    perturbPopulation(problem, nVars, oVecDeterm, oVecSamps, RandomSetStreams);
 }
 
 } // namespace CODeM
@@ -26,14 +26,23 @@
 #ifndef CODEMPROBLEMS_H
 #define CODEMPROBLEMS_H
 
+#include <core/utils/RandomStream.h>
+
 #include <cstddef>
 #include <vector>
 using std::vector;
 
 namespace CODeM {
+
+/*  The *Perturb functions without a stream argument draw from a fresh stream
+ *  of the global seed on every call. The overloads with a stream produce
+ *  samples that only depend on the seed and solution index of the stream. */
+
 vector<double>          RCP1(const vector<double> &iVec, int k, int nObj);
 vector<vector<double> > RCP1(const vector<double> &iVec, int k, int nObj, int nSamp);
 vector<vector<double> > RCP1Perturb(const vector<double> &oVec, int nSamp = 1);
+vector<vector<double> > RCP1Perturb(const vector<double> &oVec, int nSamp,
+                                    const Utils::RandomStream &rs);
 
 vector<double>          RCP2(const vector<double> &iVec, int k, int nObj);
 vector<vector<double> > RCP2(const vector<double> &iVec, int k, int nObj, int nSamp);
@@ -42,31 +51,48 @@ vector<vector<double> > RCP2Perturb(const vector<double> &oVec, int nSamp = 1);
 vector<double>          CODeM1(const vector<double> &iVec, int k, int nObj);
 vector<vector<double> > CODeM1(const vector<double> &iVec, int k, int nObj, int nSamp);
 vector<vector<double> > CODeM1Perturb(const vector<double> &oVec, int nSamp = 1);
+vector<vector<double> > CODeM1Perturb(const vector<double> &oVec, int nSamp,
+                                      const Utils::RandomStream &rs);
 
 vector<double>          CODeM2(const vector<double> &iVec, int k, int nObj);
 vector<vector<double> > CODeM2(const vector<double> &iVec, int k, int nObj, int nSamp);
 vector<vector<double> > CODeM2Perturb(const vector<double> &oVec, int nSamp = 1);
+vector<vector<double> > CODeM2Perturb(const vector<double> &oVec, int nSamp,
+                                      const Utils::RandomStream &rs);
 
 vector<double>          CODeM3(const vector<double> &iVec, int k, int nObj);
 vector<vector<double> > CODeM3(const vector<double> &iVec, int k, int nObj, int nSamp);
 vector<vector<double> > CODeM3Perturb(const vector<double> &oVec, int nSamp = 1);
+vector<vector<double> > CODeM3Perturb(const vector<double> &oVec, int nSamp,
+                                      const Utils::RandomStream &rs);
 
 vector<double>          CODeM4(const vector<double> &iVec, int k, int nObj);
 vector<vector<double> > CODeM4(const vector<double> &iVec, int k, int nObj, int nSamp);
 vector<vector<double> > CODeM4Perturb(const vector<double> &oVec, int nSamp = 1);
+vector<vector<double> > CODeM4Perturb(const vector<double> &oVec, int nSamp,
+                                      const Utils::RandomStream &rs);
 
 // CODeM5Perturb must have both decision and objective vectors defined
 vector<double>          CODeM5(const vector<double> &iVec, int k, int nObj);
 vector<vector<double> > CODeM5(const vector<double> &iVec, int k, int nObj, int nSamp);
 vector<vector<double> > CODeM5Perturb(const vector<double> &iVec,
                                       const vector<double> &oVec, int nSamp = 1);
+vector<vector<double> > CODeM5Perturb(const vector<double> &iVec,
+                                      const vector<double> &oVec, int nSamp,
+                                      const Utils::RandomStream &rs);
 
 vector<double>          CODeM6(const vector<double> &iVec, int nObj);
 vector<vector<double> > CODeM6(const vector<double> &iVec, int nObj, int nSamp);
 vector<vector<double> > CODeM6Perturb(size_t iVecSize,
                                       const vector<double> &oVec, int nSamp = 1);
+vector<vector<double> > CODeM6Perturb(size_t iVecSize,
+                                      const vector<double> &oVec, int nSamp,
+                                      const Utils::RandomStream &rs);
 vector<vector<double> > CODeM6Perturb(const vector<double> &iVec,
                                       const vector<double> &oVec, int nSamp = 1);
+vector<vector<double> > CODeM6Perturb(const vector<double> &iVec,
+                                      const vector<double> &oVec, int nSamp,
+                                      const Utils::RandomStream &rs);
 
 vector<double>          GECCOExample(const vector<double> &iVec, int nObj);
 vector<vector<double> > GECCOExample(const vector<double> &iVec, int nObj,
@@ -74,9 +100,17 @@ vector<vector<double> > GECCOExample(const vector<double> &iVec, int nObj,
 vector<vector<double> > GECCOExamplePerturb(size_t iVecSize,
                                             const vector<double> &oVec,
                                             int nSamp = 1);
+vector<vector<double> > GECCOExamplePerturb(size_t iVecSize,
+                                            const vector<double> &oVec,
+                                            int nSamp,
+                                            const Utils::RandomStream &rs);
 vector<vector<double> > GECCOExamplePerturb(const vector<double> &iVec,
                                             const vector<double> &oVec,
                                             int nSamp = 1);
+vector<vector<double> > GECCOExamplePerturb(const vector<double> &iVec,
+                                            const vector<double> &oVec,
+                                            int nSamp,
+                                            const Utils::RandomStream &rs);
 
 vector<double> deterministicOVec(int prob, const vector<double> &iVec, int nObj, int k=0);
 